@@ -0,0 +1,496 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "siddiqsoft/case-utils.hpp"
+#include "siddiqsoft/conversion-cache.hpp"
+#include "siddiqsoft/conversion-utils.hpp"
+#include "siddiqsoft/encoding-utils.hpp"
+#include "siddiqsoft/format-utils.hpp"
+#include "siddiqsoft/normalization-utils.hpp"
+
+
+namespace
+{
+    using siddiqsoft::ConversionUtils;
+    using siddiqsoft::error_policy;
+
+    /// @brief Counts the allocations made through it; the benchmarked conversions allocate their output
+    /// from one of these so each benchmark can report how many allocations a conversion costs.
+    class counting_resource : public std::pmr::memory_resource
+    {
+    public:
+        uint64_t allocations {0};
+
+    private:
+        auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override
+        {
+            allocations++;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override { return this == &other; }
+    };
+
+    /// @brief Shape of the generated input text
+    enum class profile
+    {
+        ascii,   // printable 7-bit
+        latin1,  // mostly U+00C0..U+00FF, two bytes in UTF-8
+        cjk,     // U+4E00..U+9FFF, three bytes in UTF-8
+        emoji,   // U+1F600..U+1F64F, four bytes in UTF-8 and a surrogate pair in UTF-16
+        mixed,   // runs of all of the above
+        invalid  // mixed with one malformed unit every 64 units
+    };
+
+    constexpr profile kProfiles[] {profile::ascii, profile::latin1, profile::cjk, profile::emoji, profile::mixed, profile::invalid};
+
+    constexpr const char* profile_name(profile p)
+    {
+        switch (p) {
+            case profile::ascii: return "ascii";
+            case profile::latin1: return "latin1";
+            case profile::cjk: return "cjk";
+            case profile::emoji: return "emoji";
+            case profile::mixed: return "mixed";
+            case profile::invalid: return "invalid";
+        }
+        return "?";
+    }
+
+    template <typename C>
+    constexpr const char* type_name()
+    {
+        if constexpr (std::is_same_v<C, char>) return "char";
+        else if constexpr (std::is_same_v<C, char8_t>) return "char8_t";
+        else if constexpr (std::is_same_v<C, char16_t>) return "char16_t";
+        else if constexpr (std::is_same_v<C, char32_t>) return "char32_t";
+        else return "wchar_t";
+    }
+
+    /// @brief One block of code points for the profile; whole blocks are repeated to reach the input size
+    std::u32string code_points(profile p)
+    {
+        std::u32string block;
+        for (char32_t i = 0; i < 1024; i++) {
+            switch (p) {
+                case profile::ascii: block += U' ' + (i % 95); break;
+                case profile::latin1: block += (i % 4 == 3) ? U'a' + (i % 26) : U'\x00C0' + (i % 64); break;
+                case profile::cjk: block += U'\x4E00' + (i * 7) % 0x5200; break;
+                case profile::emoji: block += U'\x1F600' + (i % 80); break;
+                case profile::mixed:
+                case profile::invalid:
+                    switch ((i / 8) % 4) {
+                        case 0: block += U'A' + (i % 26); break;
+                        case 1: block += U'\x00C0' + (i % 64); break;
+                        case 2: block += U'\x4E00' + (i * 7) % 0x5200; break;
+                        default: block += U'\x1F600' + (i % 80); break;
+                    }
+                    break;
+            }
+        }
+        return block;
+    }
+
+    /// @brief Builds `bytes` bytes (or slightly fewer, ending on a code point boundary) of input of type S
+    template <typename S>
+    std::basic_string<S> make_input(profile p, size_t bytes)
+    {
+        const auto block = ConversionUtils::convert_to<char32_t, S>(code_points(p));
+        const auto units = bytes / sizeof(S);
+
+        std::basic_string<S> out;
+        out.reserve(units + block.size());
+        while (out.size() < units) out += block;
+        out.resize(units);
+
+        // Trim a sequence cut by the resize
+        constexpr auto enc = siddiqsoft::utf::encoding_of<S>;
+        if constexpr (enc == siddiqsoft::utf::encoding::utf8) {
+            auto tail = siddiqsoft::utf::utf8_complete_prefix(reinterpret_cast<const char*>(out.data()), out.size());
+            out.resize(tail);
+        }
+        else if constexpr (enc == siddiqsoft::utf::encoding::utf16) {
+            if (!out.empty() && (out.back() & 0xFC00) == 0xD800) out.pop_back();
+        }
+
+        if (p == profile::invalid) {
+            for (size_t i = 63; i < out.size(); i += 64) {
+                if constexpr (enc == siddiqsoft::utf::encoding::utf8) out[i] = static_cast<S>(0xFF);
+                else if constexpr (enc == siddiqsoft::utf::encoding::utf16) out[i] = static_cast<S>(0xD800);
+                else out[i] = static_cast<S>(0x110000);
+            }
+        }
+        return out;
+    }
+
+    template <typename S, typename D>
+    void convert_to(benchmark::State& state, profile p)
+    {
+        const auto        src = make_input<S>(p, static_cast<size_t>(state.range(0)));
+        counting_resource resource;
+
+        for (auto _ : state) {
+            if (p == profile::invalid) {
+                // Throwing on every iteration would only measure the exception machinery
+                auto out = ConversionUtils::convert_to<S, D, error_policy::replace>(std::basic_string_view<S> {src}, &resource);
+                benchmark::DoNotOptimize(out.data());
+            }
+            else {
+                auto out = ConversionUtils::convert_to<S, D>(std::basic_string_view<S> {src}, &resource);
+                benchmark::DoNotOptimize(out.data());
+            }
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * src.size() * sizeof(S)));
+        state.counters["allocs/call"] =
+                benchmark::Counter(static_cast<double>(resource.allocations), benchmark::Counter::kAvgIterations);
+    }
+
+    /// @brief The raw transcoding kernel into a preallocated buffer: the floor that convert_to is measured against
+    template <typename S, typename D>
+    void transcode_kernel(benchmark::State& state, profile p)
+    {
+        const auto     src = make_input<S>(p, static_cast<size_t>(state.range(0)));
+        std::vector<D> out(src.size() * 4 + 4);
+
+        for (auto _ : state) {
+            auto rc = siddiqsoft::utf::transcode(src.data(), src.size(), out.data(), out.size());
+            benchmark::DoNotOptimize(rc);
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * src.size() * sizeof(S)));
+    }
+
+    /// @brief Throughput of convert_to_parallel on mixed input with `state.range(1)` threads
+    template <typename S, typename D>
+    void convert_to_parallel(benchmark::State& state)
+    {
+        const auto src     = make_input<S>(profile::mixed, static_cast<size_t>(state.range(0)));
+        const auto threads = static_cast<unsigned>(state.range(1));
+
+        for (auto _ : state) {
+            auto out = ConversionUtils::convert_to_parallel<S, D>(std::basic_string_view<S> {src}, threads);
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * src.size() * sizeof(S)));
+    }
+
+    /// @brief Repeated short header names through ConversionCache versus plain convert_to.
+    /// A cache hit only copies a shared_ptr, so the cached run reports its hit rate instead of allocations.
+    void header_names(benchmark::State& state, bool cached)
+    {
+        const std::string keys[] {"Content-Type", "Content-Length", "x-ms-version", "x-ms-client-request-id", "Authorization",
+                                  "Accept", "Accept-Encoding", "User-Agent"};
+
+        siddiqsoft::ConversionCache<char, wchar_t> cache;
+        counting_resource                          resource;
+        for (auto _ : state) {
+            for (auto& k : keys) {
+                if (cached) benchmark::DoNotOptimize(cache.get(k));
+                else benchmark::DoNotOptimize(ConversionUtils::convert_to<char, wchar_t>(std::string_view {k}, &resource));
+            }
+        }
+        const auto calls = state.iterations() * std::size(keys);
+        state.SetItemsProcessed(static_cast<int64_t>(calls));
+        if (cached) {
+            const auto stats = cache.stats();
+            state.counters["hit rate"] = benchmark::Counter(static_cast<double>(stats.hits) / static_cast<double>(calls));
+        }
+        else {
+            state.counters["allocs/call"] =
+                    benchmark::Counter(static_cast<double>(resource.allocations) / static_cast<double>(calls));
+        }
+    }
+
+    /// @brief A stream buffer that drops its output, so only the conversion into the stream is measured
+    struct null_buffer : std::streambuf
+    {
+        auto xsputn(const char*, std::streamsize n) -> std::streamsize override { return n; }
+        auto overflow(int c) -> int override { return c; }
+    };
+
+    /// @brief Wide text streamed to a std::ostream as UTF-8, through a converted std::string or as_utf8.
+    /// as_utf8 transcodes through a fixed buffer and takes no allocator, so only the converted run counts allocations.
+    void log_line(benchmark::State& state, profile p, bool direct)
+    {
+        const auto        src = make_input<wchar_t>(p, static_cast<size_t>(state.range(0)));
+        null_buffer       buffer;
+        std::ostream      os {&buffer};
+        counting_resource resource;
+
+        for (auto _ : state) {
+            if (direct) os << siddiqsoft::as_utf8(src);
+            else os << ConversionUtils::convert_to<wchar_t, char>(std::wstring_view {src}, &resource);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * src.size() * sizeof(wchar_t)));
+        if (!direct) {
+            state.counters["allocs/call"] =
+                    benchmark::Counter(static_cast<double>(resource.allocations), benchmark::Counter::kAvgIterations);
+        }
+    }
+
+    /// @brief Windows-1252 bytes decoded into D, or D encoded back into Windows-1252
+    template <typename D>
+    void codepage_cp1252(benchmark::State& state, profile p, bool decode)
+    {
+        using siddiqsoft::codepage::cp1252;
+
+        const auto text  = make_input<D>(p, static_cast<size_t>(state.range(0)));
+        const auto bytes = ConversionUtils::convert_to<D, cp1252>(std::basic_string_view<D> {text});
+        for (auto _ : state) {
+            if (decode) benchmark::DoNotOptimize(ConversionUtils::convert_to<cp1252, D>(bytes).data());
+            else benchmark::DoNotOptimize(ConversionUtils::convert_to<D, cp1252>(std::basic_string_view<D> {text}).data());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+    }
+
+    /// @brief Case-insensitive comparison and hashing of header names in narrow or wide form
+    template <typename S>
+    void header_names_icase(benchmark::State& state)
+    {
+        const auto keys  = ConversionUtils::convert_batch<char, S>(std::vector<std::string_view> {
+                "Content-Type", "Content-Length", "x-ms-version", "x-ms-client-request-id", "Authorization", "Accept"});
+        const auto upper = ConversionUtils::convert_batch<char, S>(std::vector<std::string_view> {
+                "CONTENT-TYPE", "content-length", "X-MS-Version", "X-MS-Client-Request-Id", "authorization", "ACCEPT"});
+        for (auto _ : state) {
+            for (size_t i = 0; i < keys.size(); i++) {
+                benchmark::DoNotOptimize(siddiqsoft::CaseUtils::ihash<S>(upper[i]));
+                benchmark::DoNotOptimize(siddiqsoft::CaseUtils::iequals<S>(keys[i], upper[i]));
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+    }
+
+    /// @brief NFC of already normalized text (quick check only) or NFD of the same text (decomposes the Latin-1 letters)
+    template <typename S>
+    void normalize(benchmark::State& state, profile p, siddiqsoft::normalization_form form)
+    {
+        const auto           src = make_input<S>(p, static_cast<size_t>(state.range(0)));
+        std::basic_string<S> storage;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(siddiqsoft::NormalizationUtils::normalized<S>(src, storage, form).data());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * src.size() * sizeof(S)));
+    }
+
+    /// @brief Percent-encoding of a path-like UTF-8 input (or its wide form, encoded in the same pass)
+    template <typename S>
+    void url_encode(benchmark::State& state, profile p)
+    {
+        const auto  src = make_input<S>(p, static_cast<size_t>(state.range(0)));
+        std::string out;
+        for (auto _ : state) {
+            out.clear();
+            siddiqsoft::EncodingUtils::url_encode_into<S>(src, out, siddiqsoft::url_component::path);
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * src.size() * sizeof(S)));
+    }
+
+    /// @brief JSON escaping of UTF-8 or wide input followed by unescaping into the same character type
+    template <typename S>
+    void json_roundtrip(benchmark::State& state, profile p)
+    {
+        const auto           src = make_input<S>(p, static_cast<size_t>(state.range(0)));
+        std::string          escaped;
+        std::basic_string<S> out;
+        for (auto _ : state) {
+            escaped.clear();
+            out.clear();
+            siddiqsoft::EncodingUtils::json_escape_into<S>(src, escaped);
+            siddiqsoft::EncodingUtils::json_unescape_into<S>(escaped, out);
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * src.size() * sizeof(S)));
+    }
+
+    /// @brief Base64 encode and decode of random bytes with the dispatched kernels or the scalar baseline
+    void base64(benchmark::State& state, bool decode, bool scalar)
+    {
+        using siddiqsoft::EncodingUtils;
+
+        std::vector<uint8_t> bytes(static_cast<size_t>(state.range(0)));
+        for (size_t i = 0; i < bytes.size(); i++) bytes[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+
+        const auto& kernels = scalar ? siddiqsoft::base64::kernels::scalar() : siddiqsoft::base64::kernels::get();
+        std::string text(EncodingUtils::base64_encoded_length(bytes.size()), '\0');
+        EncodingUtils::base64_encode(bytes, text, siddiqsoft::base64_variant::standard, true, kernels);
+
+        for (auto _ : state) {
+            if (decode) {
+                auto rc = EncodingUtils::base64_decode(text, bytes, siddiqsoft::base64_variant::standard,
+                                                       siddiqsoft::base64_padding::strict, kernels);
+                benchmark::DoNotOptimize(rc);
+            }
+            else {
+                auto rc = EncodingUtils::base64_encode(bytes, text, siddiqsoft::base64_variant::standard, true, kernels);
+                benchmark::DoNotOptimize(rc);
+            }
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+    }
+
+    template <typename S, typename D>
+    void register_pair()
+    {
+        for (auto p : kProfiles) {
+            auto name = std::string("convert_to<") + type_name<S>() + "," + type_name<D>() + ">/" + profile_name(p);
+            benchmark::RegisterBenchmark(name.c_str(), convert_to<S, D>, p)
+                    ->RangeMultiplier(8)
+                    ->Range(8, 64 << 20)
+                    ->Unit(benchmark::kMicrosecond);
+        }
+    }
+
+    /// @brief convert_to and the bare kernel side by side, so any cost convert_to adds on top stays visible
+    template <typename S, typename D>
+    void register_kernel()
+    {
+        for (auto p : {profile::ascii, profile::mixed}) {
+            auto name = std::string("kernel<") + type_name<S>() + "," + type_name<D>() + ">/" + profile_name(p);
+            benchmark::RegisterBenchmark(name.c_str(), transcode_kernel<S, D>, p)
+                    ->RangeMultiplier(8)
+                    ->Range(8, 64 << 20)
+                    ->Unit(benchmark::kMicrosecond);
+        }
+    }
+
+    template <typename S>
+    void register_source()
+    {
+        register_pair<S, char>();
+        register_pair<S, char8_t>();
+        register_pair<S, char16_t>();
+        register_pair<S, char32_t>();
+        register_pair<S, wchar_t>();
+    }
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+    register_source<char>();
+    register_source<char8_t>();
+    register_source<char16_t>();
+    register_source<char32_t>();
+    register_source<wchar_t>();
+    register_kernel<char, char16_t>();
+    register_kernel<char, wchar_t>();
+    register_kernel<char16_t, char>();
+    register_kernel<wchar_t, char>();
+
+    for (auto* bm : {benchmark::RegisterBenchmark("convert_to_parallel<char,wchar_t>/mixed", convert_to_parallel<char, wchar_t>),
+                     benchmark::RegisterBenchmark("convert_to_parallel<wchar_t,char>/mixed", convert_to_parallel<wchar_t, char>)})
+    {
+        bm->ArgsProduct({{16 << 20, 64 << 20}, {1, 2, 4, 8, 16}})->ArgNames({"bytes", "threads"})->UseRealTime()->Unit(benchmark::kMillisecond);
+    }
+
+    benchmark::RegisterBenchmark("header_names/convert_to", header_names, false);
+    benchmark::RegisterBenchmark("header_names/ConversionCache", header_names, true);
+    benchmark::RegisterBenchmark("header_names/icase<char>", header_names_icase<char>);
+    benchmark::RegisterBenchmark("header_names/icase<wchar_t>", header_names_icase<wchar_t>);
+
+    for (auto p : {profile::ascii, profile::mixed}) {
+        benchmark::RegisterBenchmark((std::string("url_encode<char>/") + profile_name(p)).c_str(), url_encode<char>, p)
+                ->RangeMultiplier(16)
+                ->Range(64, 1 << 20);
+        benchmark::RegisterBenchmark((std::string("url_encode<wchar_t>/") + profile_name(p)).c_str(), url_encode<wchar_t>, p)
+                ->RangeMultiplier(16)
+                ->Range(64, 1 << 20);
+    }
+
+    for (auto p : {profile::ascii, profile::mixed}) {
+        benchmark::RegisterBenchmark((std::string("json_roundtrip<char>/") + profile_name(p)).c_str(), json_roundtrip<char>, p)
+                ->RangeMultiplier(16)
+                ->Range(64, 1 << 20);
+        benchmark::RegisterBenchmark((std::string("json_roundtrip<wchar_t>/") + profile_name(p)).c_str(), json_roundtrip<wchar_t>, p)
+                ->RangeMultiplier(16)
+                ->Range(64, 1 << 20);
+    }
+
+    for (auto p : {profile::ascii, profile::mixed}) {
+        for (auto form : {siddiqsoft::normalization_form::nfc, siddiqsoft::normalization_form::nfd}) {
+            const auto suffix = std::string(form == siddiqsoft::normalization_form::nfc ? "nfc/" : "nfd/") + profile_name(p);
+            benchmark::RegisterBenchmark(("normalize<char>/" + suffix).c_str(), normalize<char>, p, form)->RangeMultiplier(16)->Range(64, 1 << 20);
+            benchmark::RegisterBenchmark(("normalize<wchar_t>/" + suffix).c_str(), normalize<wchar_t>, p, form)->RangeMultiplier(16)->Range(64, 1 << 20);
+        }
+    }
+
+    for (auto p : {profile::ascii, profile::latin1}) {
+        for (bool decode : {true, false}) {
+            const auto suffix = std::string(decode ? "decode/" : "encode/") + profile_name(p);
+            benchmark::RegisterBenchmark(("cp1252<char>/" + suffix).c_str(), codepage_cp1252<char>, p, decode)->RangeMultiplier(16)->Range(64, 1 << 20);
+            benchmark::RegisterBenchmark(("cp1252<wchar_t>/" + suffix).c_str(), codepage_cp1252<wchar_t>, p, decode)->RangeMultiplier(16)->Range(64, 1 << 20);
+        }
+    }
+
+    for (auto p : {profile::ascii, profile::mixed}) {
+        for (bool direct : {false, true}) {
+            const auto name = std::string("log_line<wchar_t>/") + (direct ? "as_utf8/" : "convert_to/") + profile_name(p);
+            benchmark::RegisterBenchmark(name.c_str(), log_line, p, direct)->RangeMultiplier(8)->Range(64, 1 << 12);
+        }
+    }
+
+    for (bool decode : {false, true}) {
+        for (bool scalar : {true, false}) {
+            auto name = std::string("base64_") + (decode ? "decode/" : "encode/") + (scalar ? "scalar" : "simd");
+            benchmark::RegisterBenchmark(name.c_str(), base64, decode, scalar)->RangeMultiplier(16)->Range(32, 1 << 20);
+        }
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,456 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifndef CASE_UTILS_HPP
+#define CASE_UTILS_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "case-fold-table.hpp"
+#include "utf-transcoder.hpp"
+
+
+/// @brief Case folding kernels used by CaseUtils
+namespace siddiqsoft::casefold
+{
+    /// @brief The simple case folding of `cp` (CaseFolding.txt status C and S); other code points are returned as they are
+    constexpr char32_t fold(char32_t cp) noexcept
+    {
+        if (cp < 0x80) return (cp >= U'A' && cp <= U'Z') ? cp + 0x20 : cp;
+
+        const auto* run = std::upper_bound(std::begin(fold_runs), std::end(fold_runs), cp,
+                                           [](char32_t c, const fold_run& r) { return c < r.first; });
+        if (run == std::begin(fold_runs)) return cp;
+        --run;
+        if (cp > run->last || (cp - run->first) % run->stride != 0) return cp;
+        return static_cast<char32_t>(static_cast<std::int32_t>(cp) + run->delta);
+    }
+
+
+    /*
+        `fold_ascii` copies the leading run of ASCII bytes of `s` to `out` in lower case and returns its length;
+        `s` and `out` may be the same buffer.
+        `equal_ascii` returns the length of the leading run where both `a` and `b` are ASCII and equal ignoring case.
+        Both stop at the first byte >= 0x80 and leave it to the caller to decode and fold the code point.
+    */
+
+    inline std::size_t fold_ascii_scalar(const char* s, std::size_t n, char* out) noexcept
+    {
+        std::size_t i = 0;
+        for (; i < n; i++) {
+            const auto b = static_cast<unsigned char>(s[i]);
+            if (b >= 0x80) break;
+            out[i] = static_cast<char>((b >= 'A' && b <= 'Z') ? b + 0x20 : b);
+        }
+        return i;
+    }
+
+    inline std::size_t equal_ascii_scalar(const char* a, const char* b, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+        for (; i < n; i++) {
+            const auto x = static_cast<unsigned char>(a[i]);
+            const auto y = static_cast<unsigned char>(b[i]);
+            if ((x | y) >= 0x80) break;
+            if (x != y && ((x | 0x20) != (y | 0x20) || (x | 0x20) < 'a' || (x | 0x20) > 'z')) break;
+        }
+        return i;
+    }
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+    /// @brief Lower-cases 'A'..'Z'; bytes >= 0x80 compare as negative and are left alone
+    inline __m128i to_lower_sse2(__m128i v) noexcept
+    {
+        const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+        return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    }
+
+    inline std::size_t fold_ascii_sse2(const char* s, std::size_t n, char* out) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            if (_mm_movemask_epi8(v) != 0) break;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), to_lower_sse2(v));
+        }
+        return i + fold_ascii_scalar(s + i, n - i, out + i);
+    }
+
+    inline std::size_t equal_ascii_sse2(const char* a, const char* b, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m128i x    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            const __m128i y    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            const __m128i same = _mm_cmpeq_epi8(to_lower_sse2(x), to_lower_sse2(y));
+            const auto    bad  = static_cast<std::uint32_t>((_mm_movemask_epi8(same) ^ 0xFFFF) | _mm_movemask_epi8(_mm_or_si128(x, y)));
+            if (bad != 0) return i + static_cast<std::size_t>(utf::lowest_bit(bad));
+        }
+        return i + equal_ascii_scalar(a + i, b + i, n - i);
+    }
+
+    SIDDIQSOFT_TARGET_AVX2 inline __m256i to_lower_avx2(__m256i v) noexcept
+    {
+        const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                               _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+        return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+    }
+
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t fold_ascii_avx2(const char* s, std::size_t n, char* out) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            if (_mm256_movemask_epi8(v) != 0) break;
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), to_lower_avx2(v));
+        }
+        return i + fold_ascii_sse2(s + i, n - i, out + i);
+    }
+
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t equal_ascii_avx2(const char* a, const char* b, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i x    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            const __m256i y    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            const __m256i same = _mm256_cmpeq_epi8(to_lower_avx2(x), to_lower_avx2(y));
+            const auto    bad  = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(same)) |
+                             static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(x, y)));
+            if (bad != 0) return i + static_cast<std::size_t>(utf::lowest_bit(bad));
+        }
+        return i + equal_ascii_sse2(a + i, b + i, n - i);
+    }
+#endif
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+    inline uint8x16_t to_lower_neon(uint8x16_t v) noexcept
+    {
+        const uint8x16_t upper = vcleq_u8(vsubq_u8(v, vdupq_n_u8('A')), vdupq_n_u8(25));
+        return vorrq_u8(v, vandq_u8(upper, vdupq_n_u8(0x20)));
+    }
+
+    inline std::size_t fold_ascii_neon(const char* s, std::size_t n, char* out) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(s + i));
+            if (vmaxvq_u8(v) >= 0x80) break;
+            vst1q_u8(reinterpret_cast<uint8_t*>(out + i), to_lower_neon(v));
+        }
+        return i + fold_ascii_scalar(s + i, n - i, out + i);
+    }
+
+    inline std::size_t equal_ascii_neon(const char* a, const char* b, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const uint8x16_t x = vld1q_u8(reinterpret_cast<const uint8_t*>(a + i));
+            const uint8x16_t y = vld1q_u8(reinterpret_cast<const uint8_t*>(b + i));
+            if (vmaxvq_u8(vorrq_u8(x, y)) >= 0x80 || vminvq_u8(vceqq_u8(to_lower_neon(x), to_lower_neon(y))) == 0) break;
+        }
+        return i + equal_ascii_scalar(a + i, b + i, n - i);
+    }
+#endif
+
+
+    struct kernels
+    {
+        std::size_t (*fold_ascii)(const char*, std::size_t, char*) noexcept;
+        std::size_t (*equal_ascii)(const char*, const char*, std::size_t) noexcept;
+
+        static const kernels& get() noexcept
+        {
+            static const kernels k = []() noexcept -> kernels {
+                switch (utf::detected_simd_level()) {
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+                    case utf::simd_level::avx2: return {&fold_ascii_avx2, &equal_ascii_avx2};
+                    case utf::simd_level::sse2: return {&fold_ascii_sse2, &equal_ascii_sse2};
+#endif
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+                    case utf::simd_level::neon: return {&fold_ascii_neon, &equal_ascii_neon};
+#endif
+                    default: return {&fold_ascii_scalar, &equal_ascii_scalar};
+                }
+            }();
+            return k;
+        }
+    };
+
+
+    /// @brief Decodes the code point at `s`; a malformed unit reads as itself offset past U+10FFFF so it
+    /// only ever matches the same unit
+    template <typename S>
+    inline std::size_t next(const S* s, std::size_t n, char32_t& cp) noexcept
+    {
+        const int units = utf::decode(s, n, cp);
+        if (units > 0) return static_cast<std::size_t>(units);
+        cp = 0x110000 + static_cast<char32_t>(static_cast<std::make_unsigned_t<S>>(s[0]));
+        return 1;
+    }
+
+
+    /// @brief Hashes the folded text as a UTF-8 byte stream in 256-byte blocks, so the result depends only on
+    /// the text and not on the encoding it came in or on where the ASCII runs end
+    class hasher
+    {
+    public:
+        static constexpr std::size_t block_size = 256;
+
+        /// @brief Where the next bytes go; up to room() ASCII bytes or one encoded code point fit
+        char*       tail() noexcept { return buf + fill; }
+        std::size_t room() const noexcept { return block_size - fill; }
+
+        void commit(std::size_t n) noexcept
+        {
+            fill += n;
+            if (fill < block_size) return;
+            mix(buf, block_size);
+            total += block_size;
+            fill -= block_size;
+            std::memmove(buf, buf + block_size, fill);
+        }
+
+        std::size_t finish() noexcept
+        {
+            mix(buf, fill);
+            h ^= total + fill;
+            // fmix64 from MurmurHash3
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            h *= 0xC4CEB9FE1A85EC53ull;
+            h ^= h >> 33;
+            return static_cast<std::size_t>(h);
+        }
+
+    private:
+        void mix(const char* p, std::size_t n) noexcept
+        {
+            for (std::size_t i = 0; i < n; i += 8) {
+                std::uint64_t w = 0;
+                std::memcpy(&w, p + i, std::min<std::size_t>(8, n - i));
+                h = (h ^ w) * 0x9E3779B97F4A7C15ull;
+                h ^= h >> 29;
+            }
+        }
+
+        std::uint64_t h {0xCBF29CE484222325ull};
+        std::uint64_t total {0};
+        std::size_t   fill {0};
+        char          buf[block_size + 8];
+    };
+} // namespace siddiqsoft::casefold
+
+
+/// @brief SiddiqSoft
+namespace siddiqsoft
+{
+    /// @brief Case-insensitive helpers for UTF-8 (`char`/`char8_t`), UTF-16, UTF-32 and wide strings using Unicode
+    /// simple case folding. ASCII runs are folded and compared with SIMD; comparison and hashing never allocate.
+    struct CaseUtils
+    {
+        /// @brief The simple case folding of the code point `cp`
+        static constexpr auto fold(char32_t cp) noexcept -> char32_t { return casefold::fold(cp); }
+
+
+        /// @brief Returns `src` case folded (in the same encoding)
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static auto fold(std::type_identity_t<std::basic_string_view<S>> src) -> std::basic_string<S>
+        {
+            std::basic_string<S> out;
+            fold_into<S>(src, out);
+            return out;
+        }
+
+
+        /// @brief Appends `src` case folded to `dst`, reusing its capacity. Malformed units are copied as they are.
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static void fold_into(std::type_identity_t<std::basic_string_view<S>> src, std::basic_string<S>& dst)
+        {
+            const auto& k = casefold::kernels::get();
+            size_t      o = dst.size();
+
+            // Folding can change the UTF-8 length of a code point (U+023A is 2 bytes, U+2C65 is 3)
+            auto room = [&](size_t count) {
+                if (dst.size() - o < count) dst.resize(std::max(o + count, dst.size() * 2));
+            };
+
+            for (size_t i = 0; i < src.size();) {
+                size_t run {};
+                if constexpr (utf::encoding_of<S> == utf::encoding::utf8) {
+                    room(src.size() - i);
+                    run = k.fold_ascii(utf::as_chars(src.data() + i), src.size() - i, utf::as_chars(dst.data() + o));
+                }
+                else {
+                    const auto& ascii = utf::ascii_kernels<S>::get();
+                    char        block[256];
+                    run = ascii.narrow(src.data() + i, std::min(src.size() - i, sizeof(block)), block);
+                    k.fold_ascii(block, run, block);
+                    room(run);
+                    ascii.widen(block, run, dst.data() + o);
+                }
+                o += run;
+                i += run;
+
+                if (i < src.size() && static_cast<uint32_t>(src[i]) >= 0x80) {
+                    char32_t  cp {};
+                    const int units = utf::decode(src.data() + i, src.size() - i, cp);
+                    room(4);
+                    if (units <= 0) {
+                        dst[o++] = src[i++];
+                        continue;
+                    }
+                    o += static_cast<size_t>(utf::encode(casefold::fold(cp), dst.data() + o));
+                    i += static_cast<size_t>(units);
+                }
+            }
+            dst.resize(o);
+        }
+
+
+        /// @brief True when `a` and `b` are equal after simple case folding. Malformed units only match themselves.
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static auto iequals(std::type_identity_t<std::basic_string_view<S>> a, std::type_identity_t<std::basic_string_view<S>> b) noexcept
+                -> bool
+        {
+            const auto& k = casefold::kernels::get();
+            size_t      i = 0, j = 0;
+
+            while (true) {
+                // Leading run where both sides are ASCII and match
+                size_t run {}, block {};
+                if constexpr (utf::encoding_of<S> == utf::encoding::utf8) {
+                    block = std::min(a.size() - i, b.size() - j);
+                    run   = k.equal_ascii(utf::as_chars(a.data() + i), utf::as_chars(b.data() + j), block);
+                }
+                else {
+                    const auto& ascii = utf::ascii_kernels<S>::get();
+                    char        x[256], y[256];
+                    block = std::min({a.size() - i, b.size() - j, sizeof(x)});
+                    run   = k.equal_ascii(x, y, std::min(ascii.narrow(a.data() + i, block, x), ascii.narrow(b.data() + j, block, y)));
+                }
+                i += run;
+                j += run;
+
+                if (i == a.size() || j == b.size()) return i == a.size() && j == b.size();
+                if (run == block) continue;
+
+                char32_t x {}, y {};
+                i += casefold::next(a.data() + i, a.size() - i, x);
+                j += casefold::next(b.data() + j, b.size() - j, y);
+                if (casefold::fold(x) != casefold::fold(y)) return false;
+            }
+        }
+
+
+        /// @brief Hash of `src` after simple case folding; strings that are `iequals` hash the same, and so does
+        /// the same text in any of the encodings
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static auto ihash(std::type_identity_t<std::basic_string_view<S>> src) noexcept -> std::size_t
+        {
+            const auto&      k = casefold::kernels::get();
+            casefold::hasher h;
+
+            for (size_t i = 0; i < src.size();) {
+                size_t run {};
+                if constexpr (utf::encoding_of<S> == utf::encoding::utf8) {
+                    run = k.fold_ascii(utf::as_chars(src.data() + i), std::min(src.size() - i, h.room()), h.tail());
+                }
+                else {
+                    run = utf::ascii_kernels<S>::get().narrow(src.data() + i, std::min(src.size() - i, h.room()), h.tail());
+                    k.fold_ascii(h.tail(), run, h.tail());
+                }
+                h.commit(run);
+                i += run;
+
+                if (i < src.size() && static_cast<uint32_t>(src[i]) >= 0x80) {
+                    char32_t cp {};
+                    i += casefold::next(src.data() + i, src.size() - i, cp);
+                    if (cp <= 0x10FFFF) {
+                        h.commit(static_cast<size_t>(utf::encode_utf8(casefold::fold(cp), h.tail())));
+                    }
+                    else {
+                        // Malformed unit: a byte that never occurs in UTF-8 followed by the unit
+                        h.tail()[0] = '\xFF';
+                        std::memcpy(h.tail() + 1, &cp, sizeof(cp));
+                        h.commit(1 + sizeof(cp));
+                    }
+                }
+            }
+            return h.finish();
+        }
+    };
+
+
+    /// @brief Case-insensitive equality for unordered containers keyed on strings of C; transparent, so lookups
+    /// take any string view without building a key
+    template <typename C>
+        requires utf::unicode_char<C>
+    struct case_insensitive_equal_to
+    {
+        using is_transparent = void;
+
+        auto operator()(std::basic_string_view<C> a, std::basic_string_view<C> b) const noexcept -> bool
+        {
+            return CaseUtils::iequals<C>(a, b);
+        }
+    };
+
+
+    /// @brief Case-insensitive hash matching case_insensitive_equal_to
+    template <typename C>
+        requires utf::unicode_char<C>
+    struct case_insensitive_hash
+    {
+        using is_transparent = void;
+
+        auto operator()(std::basic_string_view<C> s) const noexcept -> std::size_t { return CaseUtils::ihash<C>(s); }
+    };
+} // namespace siddiqsoft
+
+#endif
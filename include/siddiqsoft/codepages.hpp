@@ -0,0 +1,263 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifndef CODEPAGES_HPP
+#define CODEPAGES_HPP
+
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "codepage-tables.hpp"
+#include "utf-transcoder.hpp"
+
+
+/// @brief Single-byte codepage (Latin-1, Windows-125x, ISO 8859) transcoders used by ConversionUtils
+namespace siddiqsoft::codepage
+{
+    /// @brief A tag type naming a single-byte codepage (codepage::cp1252, codepage::iso8859_15, ...)
+    template <typename T>
+    concept single_byte = requires {
+        { T::name } -> std::convertible_to<std::string_view>;
+        requires std::same_as<std::remove_cvref_t<decltype(T::table)>, single_byte_table>;
+    };
+
+
+    /*
+        `ascii_run` returns the length of the leading run of ASCII bytes. Every codepage here agrees with
+        ASCII below 0x80, so those runs are copied (or widened) as they are.
+    */
+
+    inline std::size_t ascii_run_scalar(const char* s, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+        while (i < n && static_cast<unsigned char>(s[i]) < 0x80) i++;
+        return i;
+    }
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+    inline std::size_t ascii_run_sse2(const char* s, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)));
+            if (mask != 0) return i + static_cast<std::size_t>(utf::lowest_bit(static_cast<std::uint32_t>(mask)));
+        }
+        return i + ascii_run_scalar(s + i, n - i);
+    }
+
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t ascii_run_avx2(const char* s, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i))));
+            if (mask != 0) return i + static_cast<std::size_t>(utf::lowest_bit(mask));
+        }
+        return i + ascii_run_sse2(s + i, n - i);
+    }
+#endif
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+    inline std::size_t ascii_run_neon(const char* s, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            if (vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(s + i))) >= 0x80) break;
+        }
+        return i + ascii_run_scalar(s + i, n - i);
+    }
+#endif
+
+
+    /// @brief The ASCII run kernel for the processor, chosen once
+    inline auto ascii_run_kernel() noexcept -> std::size_t (*)(const char*, std::size_t) noexcept
+    {
+        static const auto k = []() noexcept -> std::size_t (*)(const char*, std::size_t) noexcept {
+            switch (utf::detected_simd_level()) {
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+                case utf::simd_level::avx2: return &ascii_run_avx2;
+                case utf::simd_level::sse2: return &ascii_run_sse2;
+#endif
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+                case utf::simd_level::neon: return &ascii_run_neon;
+#endif
+                default: return &ascii_run_scalar;
+            }
+        }();
+        return k;
+    }
+
+
+    inline constexpr char16_t undefined = 0xFFFF;
+
+
+    /// @brief Number of D code units decoding `n` bytes produces; undefined bytes count as U+FFFD
+    template <utf::unicode_char D>
+    inline std::size_t decoded_length(const single_byte_table& t, const char* s, std::size_t n) noexcept
+    {
+        if constexpr (utf::encoding_of<D> != utf::encoding::utf8) return n;
+
+        // 1 byte for ASCII, 2 or 3 otherwise; undefined bytes (0xFFFF) count 3, the length of U+FFFD
+        std::size_t len = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            const auto b = static_cast<unsigned char>(s[i]);
+            len += 1 + (b >> 7) * (1 + (t.to_unicode[b & 0x7F] >= 0x800));
+        }
+        return len;
+    }
+
+
+    /// @brief Decodes `n` bytes into at most `cap` units of D
+    /// @return `invalid_sequence` with `consumed` at the first undefined byte, or `output_too_small`
+    template <utf::unicode_char D>
+    inline utf::transcode_result decode(const single_byte_table& t, const char* s, std::size_t n, D* d, std::size_t cap) noexcept
+    {
+        const auto  run = ascii_run_kernel();
+        std::size_t i = 0, o = 0;
+        while (i < n) {
+            const std::size_t block = std::min(n - i, cap - o);
+            std::size_t       ascii {};
+            if constexpr (utf::encoding_of<D> == utf::encoding::utf8) {
+                ascii = run(s + i, block);
+                std::memcpy(d + o, s + i, ascii);
+            }
+            else {
+                ascii = utf::ascii_kernels<D>::get().widen(s + i, block, d + o);
+            }
+            i += ascii;
+            o += ascii;
+
+            // Mixed text: bytes are looked up one by one (ASCII stretches inline, without branching on them)
+            // until a run of ASCII long enough to be worth the vector kernel again
+            for (std::size_t streak = 0; i < n && streak < 16; i++) {
+                const auto     b  = static_cast<unsigned char>(s[i]);
+                const char16_t cp = (b < 0x80) ? char16_t {b} : t.to_unicode[b - 0x80];
+                if (cp == undefined) return {o, i, utf::transcode_status::invalid_sequence};
+                streak = (b < 0x80) ? streak + 1 : 0;
+
+                if constexpr (utf::encoding_of<D> == utf::encoding::utf8) {
+                    const unsigned c   = cp;
+                    const unsigned len = 1u + (c >= 0x80) + (c >= 0x800);
+                    if (cap - o < 3) {
+                        if (cap - o < len) return {o, i, utf::transcode_status::output_too_small};
+                        o += static_cast<std::size_t>(utf::encode(static_cast<char32_t>(cp), d + o));
+                        continue;
+                    }
+                    // All three bytes are stored and `len` of them kept
+                    d[o]     = static_cast<D>(len == 1 ? c : (len == 2 ? 0xC0 | (c >> 6) : 0xE0 | (c >> 12)));
+                    d[o + 1] = static_cast<D>(0x80 | ((len == 2 ? c : c >> 6) & 0x3F));
+                    d[o + 2] = static_cast<D>(0x80 | (c & 0x3F));
+                    o += len;
+                }
+                else {
+                    if (o == cap) return {o, i, utf::transcode_status::output_too_small};
+                    d[o++] = static_cast<D>(cp);
+                }
+            }
+        }
+        return {o, i, utf::transcode_status::ok};
+    }
+
+
+    /// @brief The byte for `cp`, or -1 when the codepage has no such character
+    inline int to_byte(const single_byte_table& t, char32_t cp) noexcept
+    {
+        if (cp < 0x80) return static_cast<int>(cp);
+        // Most of the upper half of Latin-1 and Windows-1252 maps to itself
+        if (cp < 0x100 && t.to_unicode[cp - 0x80] == cp) return static_cast<int>(cp);
+        if (cp > 0xFFFF) return -1;
+
+        const auto* end = t.from_unicode + t.count;
+        const auto* e   = std::lower_bound(t.from_unicode, end, static_cast<char16_t>(cp),
+                                         [](const single_byte_table::entry& x, char16_t c) { return x.cp < c; });
+        return (e != end && e->cp == cp) ? e->byte : -1;
+    }
+
+
+    /// @brief Encodes `n` units of S into at most `cap` bytes
+    /// @return `invalid_sequence` with `consumed` at malformed input or at a character the codepage lacks,
+    ///         `incomplete_sequence` when the input ends mid-sequence, or `output_too_small`
+    template <utf::unicode_char S>
+    inline utf::transcode_result encode(const single_byte_table& t, const S* s, std::size_t n, char* d, std::size_t cap) noexcept
+    {
+        const auto  run = ascii_run_kernel();
+        std::size_t i = 0, o = 0;
+        while (i < n) {
+            const std::size_t block = std::min(n - i, cap - o);
+            std::size_t       ascii {};
+            if constexpr (utf::encoding_of<S> == utf::encoding::utf8) {
+                ascii = run(utf::as_chars(s + i), block);
+                std::memcpy(d + o, s + i, ascii);
+            }
+            else {
+                ascii = utf::ascii_kernels<S>::get().narrow(s + i, block, d + o);
+            }
+            i += ascii;
+            o += ascii;
+
+            // As in decode: characters looked up one by one, short ASCII stretches copied inline
+            for (std::size_t streak = 0; i < n && streak < 16;) {
+                const auto u = static_cast<std::uint32_t>(static_cast<std::make_unsigned_t<S>>(s[i]));
+                if (o == cap) return {o, i, utf::transcode_status::output_too_small};
+                if (u < 0x80) {
+                    d[o++] = static_cast<char>(u);
+                    i++;
+                    streak++;
+                    continue;
+                }
+                streak = 0;
+
+                char32_t  cp {};
+                const int units = utf::decode(s + i, n - i, cp);
+                if (units <= 0) return {o, i, units < 0 ? utf::transcode_status::incomplete_sequence : utf::transcode_status::invalid_sequence};
+
+                const int b = to_byte(t, cp);
+                if (b < 0) return {o, i, utf::transcode_status::invalid_sequence};
+                d[o++] = static_cast<char>(b);
+                i += static_cast<std::size_t>(units);
+            }
+        }
+        return {o, i, utf::transcode_status::ok};
+    }
+} // namespace siddiqsoft::codepage
+
+#endif
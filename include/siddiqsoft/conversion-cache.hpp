@@ -0,0 +1,227 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifndef CONVERSION_CACHE_HPP
+#define CONVERSION_CACHE_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "conversion-utils.hpp"
+
+
+/// @brief SiddiqSoft
+namespace siddiqsoft
+{
+    /// @brief Memoizes `ConversionUtils::convert_to<S, D>` for strings converted over and over (header names,
+    /// tenant ids, ...). Entries are spread over independently locked shards, each bounded and evicted with
+    /// the CLOCK algorithm; a hit takes only a shared lock. Results are shared and immutable, so callers may
+    /// keep them after they are evicted.
+    template <typename S = char, typename D = wchar_t>
+        requires ConvertiblePair<S, D>
+    class ConversionCache
+    {
+    public:
+        using string_type = std::basic_string<D>;
+        using value_type  = std::shared_ptr<const string_type>;
+
+        /// @brief Counters summed over every shard
+        struct statistics
+        {
+            uint64_t hits {0};
+            uint64_t misses {0};
+            uint64_t evictions {0};
+            uint64_t bypassed {0}; // inputs longer than the key limit; converted but not cached
+            size_t   size {0};
+        };
+
+        /// @param capacity Total number of entries, split evenly across the shards
+        /// @param shardCount Number of independently locked shards (rounded up to a power of two)
+        /// @param maxKeyLength Longer inputs are converted without being cached
+        explicit ConversionCache(size_t capacity = 4096, size_t shardCount = 16, size_t maxKeyLength = 256)
+            : shardMask(std::bit_ceil(std::max<size_t>(shardCount, 1)) - 1)
+            , shardShift(shardMask == 0 ? 0 : std::numeric_limits<size_t>::digits - std::popcount(shardMask))
+            , keyLimit(maxKeyLength)
+            , shards(std::make_unique<shard[]>(shardMask + 1))
+        {
+            const size_t perShard = std::max<size_t>(1, (capacity + shardMask) / (shardMask + 1));
+            for (size_t i = 0; i <= shardMask; i++) shards[i].reserve(perShard);
+        }
+
+        ConversionCache(const ConversionCache&)            = delete;
+        ConversionCache& operator=(const ConversionCache&) = delete;
+
+        /// @brief The conversion of `src`, converted on the first request and shared afterwards.
+        /// Throws std::range_error (as convert_to does) for malformed input, which is never cached.
+        auto get(std::basic_string_view<S> src) -> value_type
+        {
+            if (src.size() > keyLimit) {
+                bypassed.fetch_add(1, std::memory_order_relaxed);
+                return std::make_shared<const string_type>(ConversionUtils::convert_to<S, D>(src));
+            }
+
+            // The shard comes from the high bits of the hash; the index inside the shard buckets by the low bits
+            auto& sh = shards[(std::hash<std::basic_string_view<S>> {}(src) >> shardShift) & shardMask];
+            if (auto hit = sh.find(src)) return hit;
+
+            sh.misses.fetch_add(1, std::memory_order_relaxed);
+            auto value = std::make_shared<const string_type>(ConversionUtils::convert_to<S, D>(src));
+            return sh.insert(src, std::move(value));
+        }
+
+        /// @brief Hit, miss and eviction counters plus the current number of entries
+        auto stats() const -> statistics
+        {
+            statistics out {};
+            out.bypassed = bypassed.load(std::memory_order_relaxed);
+            for (size_t i = 0; i <= shardMask; i++) {
+                const auto&                         sh = shards[i];
+                std::shared_lock<std::shared_mutex> lock(sh.guard);
+                out.hits += sh.hits.load(std::memory_order_relaxed);
+                out.misses += sh.misses.load(std::memory_order_relaxed);
+                out.evictions += sh.evictions;
+                out.size += sh.index.size();
+            }
+            return out;
+        }
+
+        /// @brief Drops every entry; results already handed out stay valid. Counters are kept.
+        void clear()
+        {
+            for (size_t i = 0; i <= shardMask; i++) shards[i].clear();
+        }
+
+    private:
+        struct slot
+        {
+            std::basic_string<S> key;
+            value_type           value;
+            std::atomic<bool>    referenced {false};
+        };
+
+        /// @brief One lock, one index and one CLOCK ring; aligned so shards do not share cache lines
+        struct alignas(64) shard
+        {
+            mutable std::shared_mutex guard;
+            // Keys are views of `slots[i].key`; the slots never move
+            std::unordered_map<std::basic_string_view<S>, size_t> index;
+            std::unique_ptr<slot[]>                              slots;
+            size_t                                               capacity {0};
+            size_t                                               used {0};
+            size_t                                               hand {0};
+            uint64_t                                             evictions {0};
+            std::atomic<uint64_t>                                hits {0};
+            std::atomic<uint64_t>                                misses {0};
+
+            void reserve(size_t n)
+            {
+                slots    = std::make_unique<slot[]>(n);
+                capacity = n;
+                index.reserve(n);
+            }
+
+            auto find(std::basic_string_view<S> key) -> value_type
+            {
+                std::shared_lock<std::shared_mutex> lock(guard);
+                auto                                it = index.find(key);
+                if (it == index.end()) return {};
+
+                auto& s = slots[it->second];
+                s.referenced.store(true, std::memory_order_relaxed);
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return s.value;
+            }
+
+            auto insert(std::basic_string_view<S> key, value_type value) -> value_type
+            {
+                std::unique_lock<std::shared_mutex> lock(guard);
+                // Another thread may have converted the same key in the meantime
+                if (auto it = index.find(key); it != index.end()) return slots[it->second].value;
+
+                size_t victim {used};
+                if (used < capacity) {
+                    used++;
+                }
+                else {
+                    // CLOCK: give every recently used entry a second chance
+                    while (slots[hand].referenced.exchange(false, std::memory_order_relaxed)) hand = (hand + 1) % capacity;
+                    victim = hand;
+                    hand   = (hand + 1) % capacity;
+                    index.erase(slots[victim].key);
+                    evictions++;
+                }
+
+                auto& s = slots[victim];
+                s.key.assign(key);
+                s.value = std::move(value);
+                s.referenced.store(false, std::memory_order_relaxed);
+                index.emplace(s.key, victim);
+                return s.value;
+            }
+
+            void clear()
+            {
+                std::unique_lock<std::shared_mutex> lock(guard);
+                index.clear();
+                for (size_t i = 0; i < used; i++) {
+                    slots[i].key.clear();
+                    slots[i].value.reset();
+                }
+                used = hand = 0;
+            }
+        };
+
+        size_t                   shardMask;
+        int                      shardShift;
+        size_t                   keyLimit;
+        std::unique_ptr<shard[]> shards;
+        std::atomic<uint64_t>    bypassed {0};
+    };
+} // namespace siddiqsoft
+
+#endif
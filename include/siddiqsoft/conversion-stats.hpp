@@ -0,0 +1,269 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifndef CONVERSION_STATS_HPP
+#define CONVERSION_STATS_HPP
+
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+// Define SIDDIQSOFT_STRINGHELPERS_STATS to count conversions; without it every hook below is an empty
+// inline function and stats::snapshot() returns zeros.
+#if defined(SIDDIQSOFT_STRINGHELPERS_STATS)
+#  include <atomic>
+#endif
+
+
+/// @brief Opt-in counters for the conversion hot paths
+namespace siddiqsoft::stats
+{
+#if defined(SIDDIQSOFT_STRINGHELPERS_STATS)
+    inline constexpr bool enabled = true;
+#else
+    inline constexpr bool enabled = false;
+#endif
+
+
+    /// @brief Number of character types counted apart in `counters::calls`
+    inline constexpr std::size_t type_count = 5;
+
+    /// @brief Row/column of the character type C in `counters::calls`: char, wchar_t, char8_t, char16_t, char32_t.
+    /// Types that share an encoding (char and char8_t; wchar_t and char32_t on Linux) are counted apart.
+    template <typename C>
+        requires std::same_as<C, char> || std::same_as<C, wchar_t> || std::same_as<C, char8_t> || std::same_as<C, char16_t> ||
+                 std::same_as<C, char32_t>
+    inline constexpr std::size_t type_index = std::same_as<C, char>       ? 0
+                                              : std::same_as<C, wchar_t>  ? 1
+                                              : std::same_as<C, char8_t>  ? 2
+                                              : std::same_as<C, char16_t> ? 3
+                                                                          : 4;
+
+
+    /// @brief Totals since the start of the process (or the last `reset`), summed over every thread
+    struct counters
+    {
+        std::uint64_t calls[type_count][type_count] {}; // ConversionUtils conversions by [source][destination] type_index
+        std::uint64_t bytes_in {0};    // input consumed by the transcoder
+        std::uint64_t bytes_out {0};   // output written by the transcoder
+        std::uint64_t ascii_bytes {0}; // input handled by the vector ASCII fast path
+        std::uint64_t allocations {0}; // output buffers allocated or grown by ConversionUtils
+        std::uint64_t errors {0};      // malformed sequences met by ConversionUtils (whatever the policy)
+
+        [[nodiscard]] auto total_calls() const noexcept -> std::uint64_t
+        {
+            std::uint64_t total {0};
+            for (const auto& row : calls)
+                for (auto c : row) total += c;
+            return total;
+        }
+
+        /// @brief Share of the input that took the ASCII fast path
+        [[nodiscard]] auto ascii_ratio() const noexcept -> double
+        {
+            return bytes_in == 0 ? 0.0 : static_cast<double>(ascii_bytes) / static_cast<double>(bytes_in);
+        }
+    };
+
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_STATS)
+    /*
+        Every thread counts into its own cache-line aligned block. A block has a single writer, so a relaxed
+        load and store (no locked read-modify-write) is enough to bump a counter; readers sum the blocks with
+        relaxed loads. A thread folds its block into `retired` when it exits. `reset` never writes to the
+        blocks: it records the current totals as the baseline that `snapshot` subtracts.
+
+        A block is registered the first time its thread converts, from inside the noexcept hooks, so
+        registering must not fail: the live blocks form an intrusive list (no allocation) guarded by a spin
+        lock on an atomic_flag (no std::system_error).
+    */
+    struct alignas(64) block
+    {
+        std::atomic<std::uint64_t> calls[type_count * type_count] {};
+        std::atomic<std::uint64_t> bytes_in {0}, bytes_out {0}, ascii_bytes {0}, allocations {0}, errors {0};
+        block*                     prev {nullptr}; // neighbours in the registry's list of live blocks
+        block*                     next {nullptr};
+
+        static void bump(std::atomic<std::uint64_t>& c, std::uint64_t n) noexcept
+        {
+            c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        void add_to(counters& t) const noexcept
+        {
+            for (std::size_t k = 0; k < type_count * type_count; k++) {
+                t.calls[k / type_count][k % type_count] += calls[k].load(std::memory_order_relaxed);
+            }
+            t.bytes_in += bytes_in.load(std::memory_order_relaxed);
+            t.bytes_out += bytes_out.load(std::memory_order_relaxed);
+            t.ascii_bytes += ascii_bytes.load(std::memory_order_relaxed);
+            t.allocations += allocations.load(std::memory_order_relaxed);
+            t.errors += errors.load(std::memory_order_relaxed);
+        }
+    };
+
+
+    class registry
+    {
+    public:
+        static auto get() noexcept -> registry&
+        {
+            static constinit registry r;
+            return r;
+        }
+
+        void attach(block* b) noexcept
+        {
+            guard lock {busy};
+            b->next = head;
+            if (head != nullptr) head->prev = b;
+            head = b;
+        }
+
+        void detach(block* b) noexcept
+        {
+            guard lock {busy};
+            b->add_to(retired);
+            if (b->prev != nullptr) b->prev->next = b->next;
+            else head = b->next;
+            if (b->next != nullptr) b->next->prev = b->prev;
+            b->prev = b->next = nullptr;
+        }
+
+        auto snapshot() noexcept -> counters
+        {
+            guard      lock {busy};
+            const auto now = totals();
+            counters   out {};
+            for (std::size_t f = 0; f < type_count; f++) {
+                for (std::size_t t = 0; t < type_count; t++) out.calls[f][t] = now.calls[f][t] - baseline.calls[f][t];
+            }
+            out.bytes_in    = now.bytes_in - baseline.bytes_in;
+            out.bytes_out   = now.bytes_out - baseline.bytes_out;
+            out.ascii_bytes = now.ascii_bytes - baseline.ascii_bytes;
+            out.allocations = now.allocations - baseline.allocations;
+            out.errors      = now.errors - baseline.errors;
+            return out;
+        }
+
+        void reset() noexcept
+        {
+            guard lock {busy};
+            baseline = totals();
+        }
+
+    private:
+        /// @brief Holds the spin lock; taken only to attach, detach or sum the blocks
+        struct guard
+        {
+            std::atomic_flag& flag;
+
+            explicit guard(std::atomic_flag& f) noexcept
+                : flag(f)
+            {
+                while (flag.test_and_set(std::memory_order_acquire)) flag.wait(true, std::memory_order_relaxed);
+            }
+
+            ~guard()
+            {
+                flag.clear(std::memory_order_release);
+                flag.notify_one();
+            }
+
+            guard(const guard&)            = delete;
+            guard& operator=(const guard&) = delete;
+        };
+
+        std::atomic_flag busy;
+        block*           head {nullptr};
+        counters         retired {}, baseline {};
+
+        auto totals() const noexcept -> counters
+        {
+            counters t {retired};
+            for (const block* b = head; b != nullptr; b = b->next) b->add_to(t);
+            return t;
+        }
+    };
+
+
+    /// @brief The calling thread's block, registered on first use
+    inline auto local() noexcept -> block&
+    {
+        struct owned : block
+        {
+            owned() { registry::get().attach(this); }
+            ~owned() { registry::get().detach(this); }
+        };
+        thread_local owned b;
+        return b;
+    }
+
+
+    /// @brief Counts one conversion from the character type `type_index` `from` to `to`
+    inline void on_call(std::size_t from, std::size_t to) noexcept { block::bump(local().calls[from * type_count + to], 1); }
+
+    inline void on_bytes(std::size_t in, std::size_t out) noexcept
+    {
+        auto& b = local();
+        block::bump(b.bytes_in, in);
+        block::bump(b.bytes_out, out);
+    }
+
+    inline void on_ascii(std::size_t n) noexcept { block::bump(local().ascii_bytes, n); }
+    inline void on_allocation() noexcept { block::bump(local().allocations, 1); }
+    inline void on_error() noexcept { block::bump(local().errors, 1); }
+
+    /// @brief The totals counted since the start of the process or the last `reset`
+    inline auto snapshot() noexcept -> counters { return registry::get().snapshot(); }
+
+    /// @brief Starts the counters over from zero
+    inline void reset() noexcept { registry::get().reset(); }
+#else
+    inline void on_call(std::size_t, std::size_t) noexcept {}
+    inline void on_bytes(std::size_t, std::size_t) noexcept {}
+    inline void on_ascii(std::size_t) noexcept {}
+    inline void on_allocation() noexcept {}
+    inline void on_error() noexcept {}
+
+    inline auto snapshot() noexcept -> counters { return {}; }
+    inline void reset() noexcept {}
+#endif
+} // namespace siddiqsoft::stats
+
+#endif
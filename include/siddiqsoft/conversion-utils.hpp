@@ -41,78 +41,726 @@
 
 #include <type_traits>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <concepts>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
 
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-
-#include <codecvt>
-#include <locale>
-
-#if defined(_WIN32) || defined(WIN32)
-#  include <windows.h>
-#endif
+#include "codepages.hpp"
+#include "utf-transcoder.hpp"
 
 /// @brief SiddiqSoft
 namespace siddiqsoft
 {
-    /// @brief Conversion Functions for ascii to wide, utf8 to wide and vice-versa
+    /// @brief The source/destination character pairs supported by ConversionUtils: every pair among
+    /// char and char8_t (UTF-8), char16_t (UTF-16), char32_t (UTF-32) and wchar_t (UTF-16 on Windows,
+    /// UTF-32 elsewhere).
+    template <typename S, typename D>
+    concept ConvertiblePair = utf::unicode_char<S> && utf::unicode_char<D>;
+
+
+    /// @brief How a conversion treats malformed input (invalid or truncated sequences, unpaired surrogates)
+    enum class error_policy
+    {
+        throw_error, // throw std::range_error
+        replace,     // substitute U+FFFD REPLACEMENT CHARACTER for each maximal invalid subpart
+        skip,        // drop the invalid units and continue
+        report       // stop and return the position and status of the error
+    };
+
+
+    /// @brief A string literal usable as a template argument; see ConversionUtils::ct_convert
+    template <utf::unicode_char C, size_t N>
+    struct fixed_string
+    {
+        C value[N] {};
+
+        consteval fixed_string(const C (&src)[N]) noexcept { std::copy_n(src, N, value); }
+
+        /// @brief The literal without its terminating NUL
+        constexpr auto view() const noexcept -> std::basic_string_view<C> { return {value, N - 1}; }
+    };
+
+
+    /// @brief Conversion Functions between UTF-8, UTF-16, UTF-32 and wide strings
     struct ConversionUtils
     {
+        using status = utf::transcode_status;
+        using result = utf::transcode_result;
+
+
+        /// @brief Either a value or the `result` describing why there is none; modelled on C++23 std::expected.
+        /// Returned by the error_policy::report conversions.
+        template <typename T>
+        class expected
+        {
+        public:
+            expected(T v)
+                : val(std::move(v))
+            {
+            }
+
+            expected(result e)
+                : err(e)
+                , hasValue(false)
+            {
+            }
+
+            [[nodiscard]] auto has_value() const noexcept -> bool { return hasValue; }
+            explicit operator bool() const noexcept { return hasValue; }
+
+            /// @brief The value; throws std::range_error when holding an error
+            auto value() & -> T&
+            {
+                if (!hasValue) throw std::range_error("ConversionUtils::expected - no value");
+                return val;
+            }
+
+            auto value() const& -> const T&
+            {
+                if (!hasValue) throw std::range_error("ConversionUtils::expected - no value");
+                return val;
+            }
+
+            auto value() && -> T&&
+            {
+                if (!hasValue) throw std::range_error("ConversionUtils::expected - no value");
+                return std::move(val);
+            }
+
+            auto operator*() & noexcept -> T& { return val; }
+            auto operator*() const& noexcept -> const T& { return val; }
+            auto operator*() && noexcept -> T&& { return std::move(val); }
+            auto operator->() noexcept -> T* { return &val; }
+            auto operator->() const noexcept -> const T* { return &val; }
+
+            /// @brief The error; meaningful only when `has_value()` is false
+            [[nodiscard]] auto error() const noexcept -> const result& { return err; }
+
+        private:
+            T      val {};
+            result err {};
+            bool   hasValue {true};
+        };
+
+
+        /// @brief Return type of convert_to: the string, or an `expected` string under error_policy::report
+        template <typename D, error_policy P, typename A = std::allocator<D>>
+        using converted_t = std::conditional_t<P == error_policy::report,
+                                               expected<std::basic_string<D, std::char_traits<D>, A>>,
+                                               std::basic_string<D, std::char_traits<D>, A>>;
+
+
+        /// @brief Checks that `src` is well-formed in its encoding (UTF-8, UTF-16 or UTF-32) without allocating.
+        /// @return `status::ok` with `consumed == src.size()` when valid; otherwise `consumed` is the offset
+        ///         (in code units) of the first invalid or incomplete sequence.
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static auto validate(std::basic_string_view<S> src) noexcept -> result
+        {
+            return utf::validate(src.data(), src.size());
+        }
+
+        /// @brief True when `src` is well-formed UTF-8
+        static auto is_valid_utf8(std::string_view src) noexcept -> bool { return validate<char>(src).status == status::ok; }
+
+        /// @brief True when `src` is well-formed UTF-8
+        static auto is_valid_utf8(std::u8string_view src) noexcept -> bool { return validate<char8_t>(src).status == status::ok; }
+
+        /// @brief True when `src` is well-formed UTF-16 (every surrogate is paired)
+        static auto is_valid_utf16(std::u16string_view src) noexcept -> bool
+        {
+            return validate<char16_t>(src).status == status::ok;
+        }
+
+
+        /// @brief Computes the exact number of D code units needed to convert `src` without allocating.
+        /// The input is assumed to be well-formed; malformed input is reported by `convert_into`.
         template <typename S = char, typename D = wchar_t>
-            requires(
-                    (std::same_as<S, char> && std::same_as<D, wchar_t>) ||
-                    (std::same_as<S, wchar_t> && std::same_as<D, char>) ||
-                    (std::same_as<S, char> && std::same_as<D, char>) ||
-                    (std::same_as<S, wchar_t> && std::same_as<D, wchar_t>))
-        static auto convert_to(const std::basic_string<S>& src) -> std::basic_string<D>
-        {
-            if constexpr ((std::is_same_v<S, char> && std::is_same_v<D, char>) ||
-                          (std::is_same_v<S, wchar_t> && std::is_same_v<D, wchar_t>))
+            requires ConvertiblePair<S, D>
+        static auto required_length(std::basic_string_view<S> src) noexcept -> size_t
+        {
+            return utf::transcoded_length<S, D>(src.data(), src.size());
+        }
+
+
+        /// @brief Converts `src` into the caller-owned buffer `dst` without allocating.
+        /// @tparam P What to do with malformed input; the default stops and reports it.
+        /// @return The number of code units written and consumed; on failure `consumed` is the
+        ///         offset of the offending (or first unconverted) source code unit.
+        template <typename S = char, typename D = wchar_t, error_policy P = error_policy::report>
+            requires ConvertiblePair<S, D>
+        static auto convert_into(std::basic_string_view<S> src, std::span<D> dst) noexcept(P != error_policy::throw_error)
+                -> result
+        {
+            count_call<S, D>();
+            return transcode_into<S, D, P>(src, dst);
+        }
+
+
+        /// @brief Converts `src` and appends the output to `dst`, reusing its existing capacity and allocator.
+        /// On failure `dst` keeps its original contents plus whatever was converted before the error.
+        template <typename S = char, typename D = wchar_t, error_policy P = error_policy::report, typename A = std::allocator<D>>
+            requires ConvertiblePair<S, D>
+        static auto convert_into(std::basic_string_view<S> src, std::basic_string<D, std::char_traits<D>, A>& dst) -> result
+        {
+            // Errors are thrown only once `dst` has been trimmed back to the converted output.
+            constexpr auto policy = (P == error_policy::throw_error) ? error_policy::report : P;
+
+            count_call<S, D>();
+            const size_t start = dst.size();
+            size_t       o {start}, i {0};
+            grow(dst, o + utf::transcode_capacity<S, D>(src.data(), src.size()));
+            while (true) {
+                auto rc = transcode_into<S, D, policy>(src.substr(i), std::span<D> {dst.data() + o, dst.size() - o});
+                i += rc.consumed;
+                o += rc.written;
+                if (rc.status != status::output_too_small) {
+                    dst.resize(o);
+                    if constexpr (P == error_policy::throw_error) {
+                        if (rc.status != status::ok) throw std::range_error("ConversionUtils::convert_to - invalid or incomplete sequence");
+                    }
+                    return {o - start, i, rc.status};
+                }
+                // Only replacement characters (or malformed input) outgrow the capacity estimate.
+                grow(dst, dst.size() + utf::transcode_capacity<S, D>(src.data() + i, src.size() - i) + utf::replacement_length<D>);
+            }
+        }
+
+
+        /// @brief Converts any contiguous range of S (std::basic_string, std::vector, std::span, ...) without
+        /// first copying it into a temporary string. Arrays and pointers go through the string_view overload.
+        template <typename S = char, typename D = wchar_t, error_policy P = error_policy::throw_error, std::ranges::contiguous_range R>
+            requires ConvertiblePair<S, D> && std::same_as<std::ranges::range_value_t<R>, S> &&
+                     (!std::is_convertible_v<const R&, const S*>)
+        static auto convert_to(const R& src) -> converted_t<D, P>
+        {
+            return convert_to<S, D, P>(std::basic_string_view<S> {std::ranges::data(src), std::ranges::size(src)});
+        }
+
+
+        /// @brief Takes ownership of `src`; the identity conversions return it without copying once it validates.
+        template <typename S = char, typename D = wchar_t, error_policy P = error_policy::throw_error, typename T>
+            requires ConvertiblePair<S, D> && std::same_as<T, std::basic_string<S>>
+        static auto convert_to(T&& src) -> converted_t<D, P>
+        {
+            if constexpr (std::is_same_v<S, D>) {
+                if (utf::validate(src.data(), src.size()).status == status::ok) return std::move(src);
+            }
+            return convert_to<S, D, P>(std::basic_string_view<S> {src});
+        }
+
+
+        /// @brief Converts `src` into a new string.
+        /// @tparam P What to do with malformed input: throw std::range_error (default), substitute U+FFFD,
+        ///           skip it, or stop and return the error in an `expected`.
+        template <typename S = char, typename D = wchar_t, error_policy P = error_policy::throw_error>
+            requires ConvertiblePair<S, D>
+        static auto convert_to(std::basic_string_view<S> src) -> converted_t<D, P>
+        {
+            return convert_to<S, D, P>(src, std::allocator<D> {});
+        }
+
+
+        /// @brief Converts `src` into a new string whose memory comes from `alloc`.
+        template <typename S = char, typename D = wchar_t, error_policy P = error_policy::throw_error, typename A>
+            requires ConvertiblePair<S, D> && std::same_as<typename A::value_type, D>
+        static auto convert_to(std::basic_string_view<S> src, const A& alloc) -> converted_t<D, P, A>
+        {
+            using string_type = std::basic_string<D, std::char_traits<D>, A>;
+
+            if constexpr (std::is_same_v<S, D>) {
+                // Well-formed input is copied as it is; malformed input goes through the policy below
+                if (utf::validate(src.data(), src.size()).status == status::ok) return string_type {src, alloc};
+            }
+
+            string_type out {alloc};
+            auto        rc = convert_into<S, D, P>(src, out);
+            if constexpr (P == error_policy::report) {
+                if (rc.status != status::ok) return converted_t<D, P, A> {rc};
+            }
+            // The output was sized by an upper bound; give back the room when most of it went unused
+            if (out.size() < out.capacity() / 2) {
+                const auto capacity = out.capacity();
+                out.shrink_to_fit();
+                if constexpr (stats::enabled) {
+                    if (out.capacity() != capacity) stats::on_allocation();
+                }
+            }
+            return out;
+        }
+
+
+        /// @brief Converts `src` into a std::pmr string allocated from `resource` (for example a per-request
+        /// std::pmr::monotonic_buffer_resource), so the output is released together with the arena.
+        template <typename S = char, typename D = wchar_t, error_policy P = error_policy::throw_error>
+            requires ConvertiblePair<S, D>
+        static auto convert_to(std::basic_string_view<S> src, std::pmr::memory_resource* resource)
+                -> converted_t<D, P, std::pmr::polymorphic_allocator<D>>
+        {
+            return convert_to<S, D, P>(src, std::pmr::polymorphic_allocator<D> {resource});
+        }
+
+
+        /// @brief Decodes `src`, text in the single-byte codepage S (`codepage::cp1252`, `codepage::latin1`,
+        /// `codepage::iso8859_15`, ...), into D. All-ASCII input is copied (or widened) as it is.
+        /// @tparam P What to do with bytes the codepage leaves undefined; `replace` substitutes U+FFFD.
+        template <typename S, typename D = wchar_t, error_policy P = error_policy::throw_error>
+            requires codepage::single_byte<S> && utf::unicode_char<D>
+        static auto convert_to(std::string_view src) -> converted_t<D, P>
+        {
+            std::basic_string<D> out;
+            const auto&          table = S::table;
+
+            if (codepage::ascii_run_kernel()(src.data(), src.size()) == src.size()) {
+                if constexpr (utf::encoding_of<D> == utf::encoding::utf8) {
+                    out.assign(reinterpret_cast<const D*>(src.data()), src.size());
+                }
+                else {
+                    out.resize(src.size());
+                    utf::ascii_kernels<D>::get().widen(src.data(), src.size(), out.data());
+                }
+                return out;
+            }
+
+            out.resize(codepage::decoded_length<D>(table, src.data(), src.size()));
+            size_t i {0}, o {0};
+            while (true) {
+                auto rc = codepage::decode(table, src.data() + i, src.size() - i, out.data() + o, out.size() - o);
+                i += rc.consumed;
+                o += rc.written;
+                if (rc.status == status::ok) break;
+
+                if constexpr (P == error_policy::throw_error) {
+                    throw std::range_error("ConversionUtils::convert_to - byte undefined in the codepage");
+                }
+                else if constexpr (P == error_policy::report) {
+                    return converted_t<D, P> {result {o, i, rc.status}};
+                }
+                else {
+                    if constexpr (P == error_policy::replace) {
+                        utf::write_replacement(out.data() + o);
+                        o += utf::replacement_length<D>;
+                    }
+                    i++;
+                }
+            }
+            out.resize(o);
+            return out;
+        }
+
+
+        /// @brief Encodes `src` into the single-byte codepage D (`codepage::cp1252`, `codepage::latin1`, ...).
+        /// All-ASCII input is copied (or narrowed) as it is.
+        /// @tparam P What to do with malformed input and characters the codepage lacks; `replace` substitutes '?'.
+        template <typename S, typename D, error_policy P = error_policy::throw_error>
+            requires utf::unicode_char<S> && codepage::single_byte<D>
+        static auto convert_to(std::basic_string_view<S> src) -> converted_t<char, P>
+        {
+            // One byte per code point, so never more bytes than input units
+            std::string out(src.size(), '\0');
+            size_t      i {0}, o {0};
+            while (true) {
+                auto rc = codepage::encode(D::table, src.data() + i, src.size() - i, out.data() + o, out.size() - o);
+                i += rc.consumed;
+                o += rc.written;
+                if (rc.status == status::ok) break;
+
+                if constexpr (P == error_policy::throw_error) {
+                    throw std::range_error("ConversionUtils::convert_to - invalid sequence or character not in the codepage");
+                }
+                else if constexpr (P == error_policy::report) {
+                    return converted_t<char, P> {result {o, i, rc.status}};
+                }
+                else {
+                    if constexpr (P == error_policy::replace) out[o++] = '?';
+
+                    // A character the codepage lacks is skipped whole, malformed input by its maximal invalid subpart
+                    char32_t  cp {};
+                    const int units = utf::decode(src.data() + i, src.size() - i, cp);
+                    i += (units > 0) ? static_cast<size_t>(units) : utf::invalid_length(src.data() + i, src.size() - i);
+                }
+            }
+            out.resize(o);
+            return out;
+        }
+
+
+        /// @brief Converts a large `src` on up to `threads` threads (0: one per hardware thread) and returns
+        /// exactly what `convert_to` returns. The input is cut at code point boundaries into chunks that the
+        /// threads pull from a shared counter; each chunk is sized first, and a prefix sum of the sizes places
+        /// its output in a single allocation. Small inputs and malformed input are converted serially.
+        template <typename S = char, typename D = wchar_t, error_policy P = error_policy::throw_error>
+            requires ConvertiblePair<S, D>
+        static auto convert_to_parallel(std::basic_string_view<S> src, unsigned threads = 0) -> converted_t<D, P>
+        {
+            // Below this many units per chunk the thread start-up outweighs the conversion
+            constexpr size_t minChunk = 256 * 1024;
+
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            if constexpr (std::is_same_v<S, D>) {
+                return convert_to<S, D, P>(src);
+            }
+            else {
+                if (threads < 2 || src.size() < 2 * minChunk) return convert_to<S, D, P>(src);
+
+                struct chunk
+                {
+                    size_t begin {0}, end {0}, offset {0}, length {0};
+                    bool   converted {false};
+                };
+
+                // A few chunks per thread keeps the threads busy when some chunks convert slower than others
+                const size_t       chunkSize = std::max(minChunk, src.size() / (size_t {threads} * 4) + 1);
+                std::vector<chunk> chunks;
+                for (size_t b = 0; b < src.size();) {
+                    const size_t e = utf::split_point(src.data(), src.size(), b + std::min(chunkSize, src.size() - b));
+                    chunks.push_back({b, e});
+                    b = e;
+                }
+                threads = static_cast<unsigned>(std::min<size_t>(threads, chunks.size()));
+
+                auto run = [&](auto&& work) {
+                    std::atomic<size_t> next {0};
+                    auto                worker = [&] {
+                        for (size_t k; (k = next.fetch_add(1, std::memory_order_relaxed)) < chunks.size();) work(chunks[k]);
+                    };
+
+                    std::vector<std::thread> pool;
+                    pool.reserve(threads - 1);
+                    try {
+                        for (unsigned t = 1; t < threads; t++) pool.emplace_back(worker);
+                    }
+                    catch (const std::system_error&) {
+                        // Fewer threads; the remaining chunks are picked up by the ones running
+                    }
+                    worker();
+                    for (auto& t : pool) t.join();
+                };
+
+                run([&](chunk& c) { c.length = required_length<S, D>(src.substr(c.begin, c.end - c.begin)); });
+
+                size_t total {0};
+                for (auto& c : chunks) {
+                    c.offset = total;
+                    total += c.length;
+                }
+
+                std::basic_string<D> out;
+                grow(out, total);
+                run([&](chunk& c) {
+                    auto rc     = utf::transcode(src.data() + c.begin, c.end - c.begin, out.data() + c.offset, c.length);
+                    c.converted = (rc.status == status::ok) && (rc.written == c.length);
+                });
+
+                if (!std::ranges::all_of(chunks, &chunk::converted)) return convert_to<S, D, P>(src);
+                count_call<S, D>();
+                return out;
+            }
+        }
+
+
+        /// @brief Converts the literal `Src` to D at compile time into a NUL-terminated array, e.g. for
+        /// constexpr lookup tables. A malformed literal fails to compile.
+        template <fixed_string Src, typename D = wchar_t>
+            requires utf::unicode_char<D>
+        static consteval auto ct_array()
+        {
+            constexpr auto src = Src.view();
+            constexpr auto len = utf::transcode_scalar(src.data(), src.size(), static_cast<D*>(nullptr), src.size() * 2);
+            static_assert(len.status == status::ok, "ConversionUtils::ct_array - invalid or incomplete sequence");
+
+            std::array<D, len.written + 1> out {};
+            utf::transcode_scalar(src.data(), src.size(), out.data(), len.written);
+            return out;
+        }
+
+
+        /// @brief The literal `Src` converted to D at compile time; the converted characters are stored in
+        /// the binary so nothing is converted or allocated at runtime. The view is NUL-terminated.
+        /// @code
+        ///     constexpr std::wstring_view key = ConversionUtils::ct_convert<"Content-Type">();
+        /// @endcode
+        template <fixed_string Src, typename D = wchar_t>
+            requires utf::unicode_char<D>
+        static consteval auto ct_convert() -> std::basic_string_view<D>
+        {
+            return {ct_storage<Src, D>.data(), ct_storage<Src, D>.size() - 1};
+        }
+
+
+        /// @brief Storage behind ct_convert: one constant per literal and destination type
+        template <fixed_string Src, typename D>
+        static constexpr auto ct_storage = ct_array<Src, D>();
+
+
+        /// @brief Incremental converter for input that arrives in chunks (network reads, file blocks).
+        /// A multi-byte sequence (or UTF-16 surrogate pair) split across chunks is carried over to the
+        /// next call to `feed`; `finish` reports input that ends in the middle of a sequence.
+        template <typename S = char, typename D = wchar_t>
+            requires ConvertiblePair<S, D>
+        class Stream
+        {
+        public:
+            /// @brief Converts `chunk` and appends the output to `out`.
+            /// @return `written` is the number of units appended; `consumed` covers the whole chunk on
+            ///         success (including any carried tail) or is the chunk offset of the failure.
+            auto feed(std::basic_string_view<S> chunk, std::basic_string<D>& out) -> result
             {
-                return src;
-            }
-            else if constexpr (std::is_same_v<S, wchar_t>) {
-#if defined(_WIN32) || defined(WIN32)
-                if (src.empty()) return std::string{};
-                // Convert wide (UTF-16 on Windows) to UTF-8
-                int size_needed = WideCharToMultiByte(CP_UTF8, 0, src.data(), static_cast<int>(src.size()), nullptr, 0, nullptr, nullptr);
-                if (size_needed <= 0) return std::string{};
-                std::string result;
-                result.resize(size_needed);
-                WideCharToMultiByte(CP_UTF8, 0, src.data(), static_cast<int>(src.size()), result.data(), size_needed, nullptr, nullptr);
-                return result;
-#else
-                std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-                return converter.to_bytes(src);
-#endif
+                size_t written {0};
+                size_t used {0};
+
+                if (pendingCount > 0) {
+                    const size_t need = required(pending[0]);
+                    while (pendingCount < need && used < chunk.size() && continues(chunk[used])) {
+                        pending[pendingCount++] = chunk[used++];
+                    }
+                    if (pendingCount < need) {
+                        if (used == chunk.size()) return {0, used, status::ok};
+                        // The sequence was interrupted by a unit that cannot continue it.
+                        pendingCount = 0;
+                        return {0, 0, status::invalid_sequence};
+                    }
+
+                    auto rc      = ConversionUtils::convert_into<S, D>({pending, pendingCount}, out);
+                    pendingCount = 0;
+                    if (rc.status != status::ok) return {rc.written, 0, rc.status};
+                    written = rc.written;
+                }
+
+                const auto rest  = chunk.substr(used);
+                const auto ready = complete(rest);
+                auto       rc    = ConversionUtils::convert_into<S, D>(rest.substr(0, ready), out);
+                if (rc.status != status::ok) return {written + rc.written, used + rc.consumed, rc.status};
+
+                for (size_t i = ready; i < rest.size(); i++) pending[pendingCount++] = rest[i];
+                return {written + rc.written, chunk.size(), status::ok};
+            }
+
+            /// @brief Converts `chunk` and returns the output; throws std::range_error on malformed input
+            auto feed(std::basic_string_view<S> chunk) -> std::basic_string<D>
+            {
+                std::basic_string<D> out;
+                if (feed(chunk, out).status != status::ok) throw std::range_error("ConversionUtils::Stream - invalid sequence");
+                return out;
             }
-            else if constexpr (std::is_same_v<S, char>) {
-#if defined(_WIN32) || defined(WIN32)
-                if (src.empty()) return std::wstring{};
-                // Convert UTF-8 to wide (UTF-16 on Windows)
-                int size_needed = MultiByteToWideChar(CP_UTF8, 0, src.data(), static_cast<int>(src.size()), nullptr, 0);
-                if (size_needed <= 0) return std::wstring{};
-                std::wstring result;
-                result.resize(size_needed);
-                MultiByteToWideChar(CP_UTF8, 0, src.data(), static_cast<int>(src.size()), result.data(), size_needed);
-                return result;
+
+            /// @brief Ends the stream and resets it for reuse.
+            /// @return `incomplete_sequence` with `consumed` set to the number of dangling units when the
+            ///         input stopped in the middle of a sequence; `ok` otherwise.
+            auto finish() noexcept -> result
+            {
+                const size_t dangling = pendingCount;
+                pendingCount          = 0;
+                return {0, dangling, dangling > 0 ? status::incomplete_sequence : status::ok};
+            }
+
+            /// @brief Number of source units carried over, waiting for the rest of their sequence
+            [[nodiscard]] auto pending_units() const noexcept -> size_t { return pendingCount; }
+
+        private:
+            /// @brief Units needed to complete the sequence that starts with `lead`
+            static auto required(S lead) noexcept -> size_t
+            {
+                if constexpr (utf::encoding_of<S> == utf::encoding::utf8) {
+                    return utf::utf8_sequence_length(static_cast<char>(lead));
+                }
+                else if constexpr (utf::encoding_of<S> == utf::encoding::utf16) {
+                    return (static_cast<uint32_t>(lead) >= 0xD800 && static_cast<uint32_t>(lead) <= 0xDBFF) ? 2 : 1;
+                }
+                else {
+                    return 1;
+                }
+            }
+
+            /// @brief True when `unit` may continue a pending sequence
+            static auto continues(S unit) noexcept -> bool
+            {
+                if constexpr (utf::encoding_of<S> == utf::encoding::utf8) {
+                    return (static_cast<unsigned char>(unit) & 0xC0) == 0x80;
+                }
+                else {
+                    return static_cast<uint32_t>(unit) >= 0xDC00 && static_cast<uint32_t>(unit) <= 0xDFFF;
+                }
+            }
+
+            /// @brief Length of the prefix of `src` that can be converted now
+            static auto complete(std::basic_string_view<S> src) noexcept -> size_t
+            {
+                // Same-encoding pairs are validated too, so they hold back a split sequence like the rest
+                if constexpr (utf::encoding_of<S> == utf::encoding::utf8) {
+                    return utf::utf8_complete_prefix(utf::as_chars(src.data()), src.size());
+                }
+                else {
+                    // A trailing high surrogate waits for its pair; UTF-32 never splits.
+                    if (!src.empty() && required(src.back()) == 2) return src.size() - 1;
+                    return src.size();
+                }
+            }
+
+            S      pending[4] {};
+            size_t pendingCount {0};
+        };
+
+
+        /// @brief Strings converted by `convert_batch`, packed back to back into a single buffer
+        template <typename D = wchar_t>
+        class Batch
+        {
+        public:
+            /// @brief Number of strings
+            auto size() const noexcept -> size_t { return bounds.size() - 1; }
+
+            auto empty() const noexcept -> bool { return size() == 0; }
+
+            /// @brief The i-th converted string; valid for the lifetime of the Batch
+            auto operator[](size_t i) const noexcept -> std::basic_string_view<D>
+            {
+                return {arena.data() + bounds[i], bounds[i + 1] - bounds[i]};
+            }
+
+            /// @brief The `size() + 1` offsets into `data()`: string i spans [offsets()[i], offsets()[i + 1])
+            auto offsets() const noexcept -> std::span<const size_t> { return bounds; }
+
+            /// @brief The packed output of every string (not NUL-separated)
+            auto data() const noexcept -> const D* { return arena.data(); }
+
+            /// @brief A view per string, in input order
+            auto views() const -> std::vector<std::basic_string_view<D>>
+            {
+                std::vector<std::basic_string_view<D>> out;
+                out.reserve(size());
+                for (size_t i = 0; i < size(); i++) out.push_back((*this)[i]);
+                return out;
+            }
+
+        private:
+            friend struct ConversionUtils;
+
+            std::basic_string<D> arena;
+            std::vector<size_t>  bounds {0};
+        };
+
+
+        /// @brief Converts every string in `inputs` (strings, string views or NUL-terminated pointers) into one
+        /// contiguous Batch. A pre-pass sizes all of the output so the batch costs one buffer and one offsets
+        /// table instead of one allocation per string.
+        /// @tparam P throw_error (default), replace or skip; use `validate` to locate a malformed string.
+        template <typename S = char, typename D = wchar_t, error_policy P = error_policy::throw_error, std::ranges::forward_range R>
+            requires ConvertiblePair<S, D> && (P != error_policy::report) &&
+                     std::is_convertible_v<std::ranges::range_reference_t<const R&>, std::basic_string_view<S>>
+        static auto convert_batch(const R& inputs) -> Batch<D>
+        {
+            Batch<D> out;
+            size_t   total {0}, count {0};
+            for (std::basic_string_view<S> src : inputs) {
+                total += required_length<S, D>(src);
+                count++;
+            }
+            out.bounds.reserve(count + 1);
+            grow(out.arena, total);
+
+            size_t o {0};
+            for (std::basic_string_view<S> src : inputs) {
+                count_call<S, D>();
+                while (true) {
+                    auto rc = transcode_into<S, D, P>(src, std::span<D> {out.arena.data() + o, out.arena.size() - o});
+                    o += rc.written;
+                    if (rc.status != status::output_too_small) break;
+
+                    // Only replacement characters outgrow the exact length estimate.
+                    src.remove_prefix(rc.consumed);
+                    grow(out.arena, out.arena.size() + required_length<S, D>(src) + utf::replacement_length<D>);
+                }
+                out.bounds.push_back(o);
+            }
+            out.arena.resize(o);
+            return out;
+        }
+
+    private:
+        template <typename S, typename D>
+        static void count_call() noexcept
+        {
+            stats::on_call(stats::type_index<S>, stats::type_index<D>);
+        }
+
+        /// @brief Resizes the output `s` for the conversion to overwrite, counting the allocation when its buffer
+        /// has to grow
+        template <typename D, typename A>
+        static void grow(std::basic_string<D, std::char_traits<D>, A>& s, size_t n)
+        {
+            [[maybe_unused]] const auto capacity = s.capacity();
+#if defined(__cpp_lib_string_resize_and_overwrite)
+            // The new units are written by the conversion, so they are not zero-filled first
+            s.resize_and_overwrite(n, [](D*, size_t count) noexcept { return count; });
 #else
-                std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-                return converter.from_bytes(src);
+            if constexpr (std::is_same_v<D, char16_t> || std::is_same_v<D, char32_t>) {
+                // Their char_traits fill one unit at a time; copying the string onto itself costs a memcpy
+                // instead, and the new units are overwritten by the conversion either way.
+                if (n > s.size()) {
+                    s.reserve(n);
+                    if (s.empty()) s.push_back(D {});
+                    while (s.size() < n) s.append(s.data(), std::min(s.size(), n - s.size()));
+                }
+                else {
+                    s.resize(n);
+                }
+            }
+            else {
+                s.resize(n);
+            }
 #endif
+            if constexpr (stats::enabled) {
+                if (s.capacity() != capacity) stats::on_allocation();
             }
+        }
 
-            // We should not end up here!
-            return std::basic_string<D> {};
+        /// @brief convert_into for the span `dst`, without counting a call
+        template <typename S, typename D, error_policy P>
+        static auto transcode_into(std::basic_string_view<S> src, std::span<D> dst) noexcept(P != error_policy::throw_error)
+                -> result
+        {
+            size_t i {0}, o {0};
+            while (true) {
+                auto rc = utf::transcode(src.data() + i, src.size() - i, dst.data() + o, dst.size() - o);
+                i += rc.consumed;
+                o += rc.written;
+                if (rc.status == status::ok || rc.status == status::output_too_small) return {o, i, rc.status};
+
+                // Room is checked first so that the error, met again once the caller has made room, counts once
+                if constexpr (P == error_policy::replace) {
+                    if (dst.size() - o < utf::replacement_length<D>) return {o, i, status::output_too_small};
+                }
+                stats::on_error();
+
+                if constexpr (P == error_policy::throw_error) {
+                    throw std::range_error("ConversionUtils::convert_into - invalid or incomplete sequence");
+                }
+                else if constexpr (P == error_policy::report) {
+                    return {o, i, rc.status};
+                }
+                else {
+                    if constexpr (P == error_policy::replace) {
+                        utf::write_replacement(dst.data() + o);
+                        o += utf::replacement_length<D>;
+                    }
+                    i += utf::invalid_length(src.data() + i, src.size() - i);
+                }
+            }
         }
     };
 } // namespace siddiqsoft
 
-#pragma GCC diagnostic pop
-#pragma clang diagnostic pop
-
 #endif
@@ -0,0 +1,1059 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifndef ENCODING_UTILS_HPP
+#define ENCODING_UTILS_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "utf-transcoder.hpp"
+
+
+/// @brief SiddiqSoft
+namespace siddiqsoft
+{
+    /// @brief The URL component being encoded; selects which characters (besides the RFC 3986 unreserved
+    /// set `A-Z a-z 0-9 - . _ ~`) are left as they are.
+    enum class url_component
+    {
+        unreserved,   // only the unreserved set; safe anywhere (query keys and values, Azure canonical paths)
+        path_segment, // pchar: unreserved, sub-delims, ':' and '@'
+        path,         // pchar and '/'
+        query,        // pchar, '/' and '?'
+        fragment,     // pchar, '/' and '?'
+        form          // application/x-www-form-urlencoded: unreserved, with space as '+'
+    };
+
+
+    /// @brief Base64 alphabet (RFC 4648): `+/` or the URL and filename safe `-_`
+    enum class base64_variant
+    {
+        standard,
+        url
+    };
+
+
+    /// @brief How base64 decoding treats '=' padding
+    enum class base64_padding
+    {
+        strict, // padding required to a multiple of 4 characters, unused trailing bits must be zero
+        lenient // padding optional; unused trailing bits are ignored
+    };
+} // namespace siddiqsoft
+
+
+/// @brief Percent-encoding tables and kernels used by EncodingUtils
+namespace siddiqsoft::url
+{
+    /// @brief Bytes left unescaped for one url_component
+    struct component_table
+    {
+        bool         allowed[256] {};
+        std::uint8_t nibbles[16] {}; // for low nibble l, bit h is set when byte (h << 4 | l) is allowed
+    };
+
+
+    constexpr component_table make_component_table(url_component c) noexcept
+    {
+        component_table t {};
+        auto            allow = [&t](std::string_view chars) {
+            for (char ch : chars) t.allowed[static_cast<unsigned char>(ch)] = true;
+        };
+
+        allow("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-._~");
+        if (c != url_component::unreserved && c != url_component::form) allow("!$&'()*+,;=:@");
+        if (c == url_component::path || c == url_component::query || c == url_component::fragment) allow("/");
+        if (c == url_component::query || c == url_component::fragment) allow("?");
+
+        for (unsigned b = 0; b < 0x80; b++) {
+            if (t.allowed[b]) t.nibbles[b & 0x0F] |= static_cast<std::uint8_t>(1u << (b >> 4));
+        }
+        return t;
+    }
+
+
+    inline constexpr component_table component_tables[] {make_component_table(url_component::unreserved),
+                                                          make_component_table(url_component::path_segment),
+                                                          make_component_table(url_component::path),
+                                                          make_component_table(url_component::query),
+                                                          make_component_table(url_component::fragment),
+                                                          make_component_table(url_component::form)};
+
+
+    /// @brief Value of the hexadecimal digit `c`, or -1
+    constexpr int hex_value(char c) noexcept
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
+
+    /*
+        Scanning kernels
+
+        `safe_run` returns the length of the leading run of bytes that need no escaping; the vector versions
+        classify 32 (AVX2) or 16 (NEON) bytes at a time with two nibble table lookups. `escape_run` returns
+        the length of the leading run without '%' (or '+' when `plus` is set) for the decoder.
+    */
+
+    inline std::size_t safe_run_scalar(const char* s, std::size_t n, const component_table& t) noexcept
+    {
+        std::size_t i = 0;
+        while (i < n && t.allowed[static_cast<unsigned char>(s[i])]) i++;
+        return i;
+    }
+
+    inline std::size_t escape_run_scalar(const char* s, std::size_t n, bool plus) noexcept
+    {
+        std::size_t i = 0;
+        while (i < n && s[i] != '%' && !(plus && s[i] == '+')) i++;
+        return i;
+    }
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+    inline std::size_t escape_run_sse2(const char* s, std::size_t n, bool plus) noexcept
+    {
+        const __m128i pct = _mm_set1_epi8('%');
+        const __m128i add = _mm_set1_epi8(plus ? '+' : '%');
+        std::size_t   i   = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            const int     mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, pct), _mm_cmpeq_epi8(v, add)));
+            if (mask != 0) return i + static_cast<std::size_t>(utf::lowest_bit(static_cast<std::uint32_t>(mask)));
+        }
+        return i + escape_run_scalar(s + i, n - i, plus);
+    }
+
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t safe_run_avx2(const char* s, std::size_t n, const component_table& t) noexcept
+    {
+        const __m256i nibbles = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t.nibbles)));
+        // Bit for each high nibble; bytes >= 0x80 map to 0 and are never allowed
+        const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0,
+                                              1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i low  = _mm256_set1_epi8(0x0F);
+        const __m256i zero = _mm256_setzero_si256();
+
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            const __m256i lo = _mm256_shuffle_epi8(nibbles, _mm256_and_si256(v, low));
+            const __m256i hi = _mm256_shuffle_epi8(bits, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+            const auto    bad =
+                    static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), zero)));
+            if (bad != 0) return i + static_cast<std::size_t>(utf::lowest_bit(bad));
+        }
+        return i + safe_run_scalar(s + i, n - i, t);
+    }
+
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t escape_run_avx2(const char* s, std::size_t n, bool plus) noexcept
+    {
+        const __m256i pct = _mm256_set1_epi8('%');
+        const __m256i add = _mm256_set1_epi8(plus ? '+' : '%');
+        std::size_t   i   = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            const auto    mask = static_cast<std::uint32_t>(
+                    _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, pct), _mm256_cmpeq_epi8(v, add))));
+            if (mask != 0) return i + static_cast<std::size_t>(utf::lowest_bit(mask));
+        }
+        return i + escape_run_sse2(s + i, n - i, plus);
+    }
+#endif
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+    inline std::size_t safe_run_neon(const char* s, std::size_t n, const component_table& t) noexcept
+    {
+        const uint8x16_t nibbles = vld1q_u8(t.nibbles);
+        const uint8_t    bitsTable[16] {1, 2, 4, 8, 16, 32, 64, 128, 0, 0, 0, 0, 0, 0, 0, 0};
+        const uint8x16_t bits = vld1q_u8(bitsTable);
+        const uint8x16_t low  = vdupq_n_u8(0x0F);
+
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const uint8x16_t v  = vld1q_u8(reinterpret_cast<const uint8_t*>(s + i));
+            const uint8x16_t lo = vqtbl1q_u8(nibbles, vandq_u8(v, low));
+            const uint8x16_t hi = vqtbl1q_u8(bits, vshrq_n_u8(v, 4));
+            if (vminvq_u8(vandq_u8(lo, hi)) == 0) break;
+        }
+        return i + safe_run_scalar(s + i, n - i, t);
+    }
+
+    inline std::size_t escape_run_neon(const char* s, std::size_t n, bool plus) noexcept
+    {
+        const uint8x16_t pct = vdupq_n_u8('%');
+        const uint8x16_t add = vdupq_n_u8(plus ? '+' : '%');
+        std::size_t      i   = 0;
+        for (; i + 16 <= n; i += 16) {
+            const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(s + i));
+            if (vmaxvq_u8(vorrq_u8(vceqq_u8(v, pct), vceqq_u8(v, add))) != 0) break;
+        }
+        return i + escape_run_scalar(s + i, n - i, plus);
+    }
+#endif
+
+
+    /// @brief Scanning kernels for the processor, chosen once
+    struct kernels
+    {
+        std::size_t (*safe_run)(const char*, std::size_t, const component_table&) noexcept;
+        std::size_t (*escape_run)(const char*, std::size_t, bool) noexcept;
+
+        static const kernels& get() noexcept
+        {
+            static const kernels k = []() noexcept -> kernels {
+                switch (utf::detected_simd_level()) {
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+                    case utf::simd_level::avx2: return {&safe_run_avx2, &escape_run_avx2};
+                    // The nibble lookup needs a byte shuffle, which SSE2 lacks
+                    case utf::simd_level::sse2: return {&safe_run_scalar, &escape_run_sse2};
+#endif
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+                    case utf::simd_level::neon: return {&safe_run_neon, &escape_run_neon};
+#endif
+                    default: return {&safe_run_scalar, &escape_run_scalar};
+                }
+            }();
+            return k;
+        }
+    };
+} // namespace siddiqsoft::url
+
+
+/// @brief Base64 (RFC 4648) tables and kernels used by EncodingUtils
+namespace siddiqsoft::base64
+{
+    inline constexpr char standard_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    inline constexpr char url_alphabet[]      = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+
+    /// @brief Maps a character to its 6-bit value, or -1 when it is not in the alphabet
+    struct decode_table
+    {
+        std::int8_t value[256] {};
+    };
+
+    constexpr decode_table make_decode_table(const char* alphabet) noexcept
+    {
+        decode_table t {};
+        for (auto& v : t.value) v = -1;
+        for (int i = 0; i < 64; i++) t.value[static_cast<unsigned char>(alphabet[i])] = static_cast<std::int8_t>(i);
+        return t;
+    }
+
+    inline constexpr decode_table standard_table = make_decode_table(standard_alphabet);
+    inline constexpr decode_table url_table      = make_decode_table(url_alphabet);
+
+
+    /*
+        Block kernels
+
+        `encode` converts whole 3-byte groups and returns the number of input bytes consumed (writing 4/3 as
+        many characters); `decode` converts whole 4-character groups, stops in front of the first block that
+        holds a character outside the alphabet (padding included) and returns the characters consumed. Both
+        leave the remainder to the scalar code in EncodingUtils, which handles padding and reports errors.
+    */
+
+    inline std::size_t encode_scalar(const std::uint8_t* s, std::size_t n, char* d, bool url) noexcept
+    {
+        const char* alphabet = url ? url_alphabet : standard_alphabet;
+        std::size_t i        = 0;
+        for (; i + 3 <= n; i += 3, d += 4) {
+            const std::uint32_t v = (std::uint32_t {s[i]} << 16) | (std::uint32_t {s[i + 1]} << 8) | s[i + 2];
+            d[0]                  = alphabet[(v >> 18) & 0x3F];
+            d[1]                  = alphabet[(v >> 12) & 0x3F];
+            d[2]                  = alphabet[(v >> 6) & 0x3F];
+            d[3]                  = alphabet[v & 0x3F];
+        }
+        return i;
+    }
+
+    inline std::size_t decode_scalar(const char* s, std::size_t n, std::uint8_t* d, std::size_t cap, bool url) noexcept
+    {
+        const auto& t = url ? url_table : standard_table;
+        std::size_t i = 0;
+        for (; i + 4 <= n && (i / 4 + 1) * 3 <= cap; i += 4, d += 3) {
+            const int a = t.value[static_cast<unsigned char>(s[i])];
+            const int b = t.value[static_cast<unsigned char>(s[i + 1])];
+            const int c = t.value[static_cast<unsigned char>(s[i + 2])];
+            const int e = t.value[static_cast<unsigned char>(s[i + 3])];
+            if ((a | b | c | e) < 0) break;
+
+            const auto v = (static_cast<std::uint32_t>(a) << 18) | (static_cast<std::uint32_t>(b) << 12) |
+                           (static_cast<std::uint32_t>(c) << 6) | static_cast<std::uint32_t>(e);
+            d[0] = static_cast<std::uint8_t>(v >> 16);
+            d[1] = static_cast<std::uint8_t>(v >> 8);
+            d[2] = static_cast<std::uint8_t>(v);
+        }
+        return i;
+    }
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+    /// @brief 24 bytes to 32 characters per step (Muła's multiply-shift split and lookup)
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t encode_avx2(const std::uint8_t* s, std::size_t n, char* d, bool url) noexcept
+    {
+        const __m256i split = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                               1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+        // Offset added to each 6-bit index, selected by its range (A-Z, a-z, 0-9, 62, 63)
+        const char    c62   = url ? '-' : '+';
+        const char    c63   = url ? '_' : '/';
+        const __m256i shift = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, static_cast<char>(c62 - 62),
+                                               static_cast<char>(c63 - 63), 'A', 0, 0, 'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               static_cast<char>(c62 - 62), static_cast<char>(c63 - 63), 'A', 0, 0);
+
+        std::size_t i = 0;
+        for (; i + 28 <= n; i += 24, d += 32) {
+            // 12 bytes in each 128-bit lane
+            const __m256i in = _mm256_shuffle_epi8(
+                    _mm256_set_m128i(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 12)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i))),
+                    split);
+
+            const __m256i t0  = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+            const __m256i t1  = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+            const __m256i idx = _mm256_or_si256(t0, t1);
+
+            __m256i       sel  = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+            const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+            sel                = _mm256_or_si256(sel, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), _mm256_add_epi8(idx, _mm256_shuffle_epi8(shift, sel)));
+        }
+        return i + encode_scalar(s + i, n - i, d, url);
+    }
+
+    /// @brief Lanes of `v` in the signed byte range [lo, hi]
+    SIDDIQSOFT_TARGET_AVX2 inline __m256i in_range_avx2(__m256i v, char lo, char hi) noexcept
+    {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                                _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+    }
+
+    /// @brief 32 characters to 24 bytes per step; characters are classified by range so both alphabets share it
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t decode_avx2(const char* s, std::size_t n, std::uint8_t* d, std::size_t cap, bool url) noexcept
+    {
+        const __m256i c62   = _mm256_set1_epi8(url ? '-' : '+');
+        const __m256i c63   = _mm256_set1_epi8(url ? '_' : '/');
+        const __m256i pack  = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                               2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        const __m256i order = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+        std::size_t i = 0, o = 0;
+        for (; i + 32 <= n && o + 32 <= cap; i += 32, o += 24) {
+            const __m256i in    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            const __m256i upper = in_range_avx2(in, 'A', 'Z');
+            const __m256i lower = in_range_avx2(in, 'a', 'z');
+            const __m256i digit = in_range_avx2(in, '0', '9');
+            const __m256i is62  = _mm256_cmpeq_epi8(in, c62);
+            const __m256i is63  = _mm256_cmpeq_epi8(in, c63);
+
+            const __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_or_si256(is62, is63)));
+            if (_mm256_movemask_epi8(valid) != -1) break;
+
+            __m256i delta = _mm256_and_si256(upper, _mm256_set1_epi8(-65));
+            delta         = _mm256_or_si256(delta, _mm256_and_si256(lower, _mm256_set1_epi8(-71)));
+            delta         = _mm256_or_si256(delta, _mm256_and_si256(digit, _mm256_set1_epi8(4)));
+            delta         = _mm256_or_si256(delta, _mm256_and_si256(is62, _mm256_sub_epi8(_mm256_set1_epi8(62), c62)));
+            delta         = _mm256_or_si256(delta, _mm256_and_si256(is63, _mm256_sub_epi8(_mm256_set1_epi8(63), c63)));
+            const __m256i values = _mm256_add_epi8(in, delta);
+
+            // Four 6-bit values to three bytes per 32-bit group, then the 12 bytes of each lane together
+            const __m256i ab  = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+            const __m256i abc = _mm256_madd_epi16(ab, _mm256_set1_epi32(0x00011000));
+            const __m256i out = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(abc, pack), order);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + o), out);
+        }
+        return i + decode_scalar(s + i, n - i, d + o, cap - o, url);
+    }
+#endif
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+    /// @brief 48 bytes to 64 characters per step using de-interleaving loads and a 64-entry table lookup
+    inline std::size_t encode_neon(const std::uint8_t* s, std::size_t n, char* d, bool url) noexcept
+    {
+        const uint8x16x4_t alphabet = vld1q_u8_x4(reinterpret_cast<const uint8_t*>(url ? url_alphabet : standard_alphabet));
+        const uint8x16_t   m3f      = vdupq_n_u8(0x3F);
+
+        std::size_t i = 0;
+        for (; i + 48 <= n; i += 48, d += 64) {
+            const uint8x16x3_t in = vld3q_u8(s + i);
+            uint8x16x4_t       idx;
+            idx.val[0] = vshrq_n_u8(in.val[0], 2);
+            idx.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), m3f);
+            idx.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), m3f);
+            idx.val[3] = vandq_u8(in.val[2], m3f);
+
+            uint8x16x4_t out;
+            for (int k = 0; k < 4; k++) out.val[k] = vqtbl4q_u8(alphabet, idx.val[k]);
+            vst4q_u8(reinterpret_cast<uint8_t*>(d), out);
+        }
+        return i + encode_scalar(s + i, n - i, d, url);
+    }
+
+    /// @brief 64 characters to 48 bytes per step
+    inline std::size_t decode_neon(const char* s, std::size_t n, std::uint8_t* d, std::size_t cap, bool url) noexcept
+    {
+        const uint8x16_t c62 = vdupq_n_u8(url ? '-' : '+');
+        const uint8x16_t c63 = vdupq_n_u8(url ? '_' : '/');
+
+        auto between = [](uint8x16_t v, uint8_t lo, uint8_t hi) { return vandq_u8(vcgeq_u8(v, vdupq_n_u8(lo)), vcleq_u8(v, vdupq_n_u8(hi))); };
+
+        std::size_t i = 0, o = 0;
+        for (; i + 64 <= n && o + 48 <= cap; i += 64, o += 48) {
+            const uint8x16x4_t in = vld4q_u8(reinterpret_cast<const uint8_t*>(s + i));
+            uint8x16x4_t       v;
+            uint8x16_t         valid = vdupq_n_u8(0xFF);
+            for (int k = 0; k < 4; k++) {
+                const uint8x16_t c     = in.val[k];
+                const uint8x16_t upper = between(c, 'A', 'Z');
+                const uint8x16_t lower = between(c, 'a', 'z');
+                const uint8x16_t digit = between(c, '0', '9');
+                const uint8x16_t is62  = vceqq_u8(c, c62);
+                const uint8x16_t is63  = vceqq_u8(c, c63);
+                valid                  = vandq_u8(valid, vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, vorrq_u8(is62, is63))));
+
+                uint8x16_t delta = vandq_u8(upper, vdupq_n_u8(static_cast<uint8_t>(-65)));
+                delta            = vorrq_u8(delta, vandq_u8(lower, vdupq_n_u8(static_cast<uint8_t>(-71))));
+                delta            = vorrq_u8(delta, vandq_u8(digit, vdupq_n_u8(4)));
+                delta            = vorrq_u8(delta, vandq_u8(is62, vsubq_u8(vdupq_n_u8(62), c62)));
+                delta            = vorrq_u8(delta, vandq_u8(is63, vsubq_u8(vdupq_n_u8(63), c63)));
+                v.val[k]         = vaddq_u8(c, delta);
+            }
+            if (vminvq_u8(valid) == 0) break;
+
+            uint8x16x3_t out;
+            out.val[0] = vorrq_u8(vshlq_n_u8(v.val[0], 2), vshrq_n_u8(v.val[1], 4));
+            out.val[1] = vorrq_u8(vshlq_n_u8(v.val[1], 4), vshrq_n_u8(v.val[2], 2));
+            out.val[2] = vorrq_u8(vshlq_n_u8(v.val[2], 6), v.val[3]);
+            vst3q_u8(d + o, out);
+        }
+        return i + decode_scalar(s + i, n - i, d + o, cap - o, url);
+    }
+#endif
+
+
+    /// @brief Block kernels for the processor, chosen once
+    struct kernels
+    {
+        std::size_t (*encode)(const std::uint8_t*, std::size_t, char*, bool) noexcept;
+        std::size_t (*decode)(const char*, std::size_t, std::uint8_t*, std::size_t, bool) noexcept;
+
+        static const kernels& scalar() noexcept
+        {
+            static constexpr kernels k {&encode_scalar, &decode_scalar};
+            return k;
+        }
+
+        static const kernels& get() noexcept
+        {
+            static const kernels k = []() noexcept -> kernels {
+                switch (utf::detected_simd_level()) {
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+                    case utf::simd_level::avx2: return {&encode_avx2, &decode_avx2};
+#endif
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+                    case utf::simd_level::neon: return {&encode_neon, &decode_neon};
+#endif
+                    default: return scalar();
+                }
+            }();
+            return k;
+        }
+    };
+} // namespace siddiqsoft::base64
+
+
+/// @brief JSON string scanning kernels used by EncodingUtils
+namespace siddiqsoft::json
+{
+    /*
+        `clean_run` returns the length of the leading run of bytes that may appear in a JSON string as they
+        are: everything except control characters (< 0x20), '"' and '\'. Bytes >= 0x80 are clean so UTF-8
+        passes through. The escaper uses it to skip text that needs no escaping and the unescaper to find
+        the next escape sequence.
+    */
+
+    inline std::size_t clean_run_scalar(const char* s, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+        for (; i < n; i++) {
+            const auto b = static_cast<unsigned char>(s[i]);
+            if (b < 0x20 || b == '"' || b == '\\') break;
+        }
+        return i;
+    }
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+    inline std::size_t clean_run_sse2(const char* s, std::size_t n) noexcept
+    {
+        const __m128i quote     = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control   = _mm_set1_epi8(0x1F);
+        std::size_t   i         = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            // v <= 0x1F (unsigned) exactly when max(v, 0x1F) == 0x1F
+            const __m128i bad  = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                              _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+            const int     mask = _mm_movemask_epi8(bad);
+            if (mask != 0) return i + static_cast<std::size_t>(utf::lowest_bit(static_cast<std::uint32_t>(mask)));
+        }
+        return i + clean_run_scalar(s + i, n - i);
+    }
+
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t clean_run_avx2(const char* s, std::size_t n) noexcept
+    {
+        const __m256i quote     = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i control   = _mm256_set1_epi8(0x1F);
+        std::size_t   i         = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            const __m256i bad  = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+                                                 _mm256_cmpeq_epi8(_mm256_max_epu8(v, control), control));
+            const auto    mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(bad));
+            if (mask != 0) return i + static_cast<std::size_t>(utf::lowest_bit(mask));
+        }
+        return i + clean_run_sse2(s + i, n - i);
+    }
+#endif
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+    inline std::size_t clean_run_neon(const char* s, std::size_t n) noexcept
+    {
+        const uint8x16_t quote     = vdupq_n_u8('"');
+        const uint8x16_t backslash = vdupq_n_u8('\\');
+        const uint8x16_t space     = vdupq_n_u8(0x20);
+        std::size_t      i         = 0;
+        for (; i + 16 <= n; i += 16) {
+            const uint8x16_t v   = vld1q_u8(reinterpret_cast<const uint8_t*>(s + i));
+            const uint8x16_t bad = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vcltq_u8(v, space));
+            if (vmaxvq_u8(bad) != 0) break;
+        }
+        return i + clean_run_scalar(s + i, n - i);
+    }
+#endif
+
+
+    /// @brief The clean-run kernel for the processor, chosen once
+    inline auto clean_run_kernel() noexcept -> std::size_t (*)(const char*, std::size_t) noexcept
+    {
+        static const auto k = []() noexcept -> std::size_t (*)(const char*, std::size_t) noexcept {
+            switch (utf::detected_simd_level()) {
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+                case utf::simd_level::avx2: return &clean_run_avx2;
+                case utf::simd_level::sse2: return &clean_run_sse2;
+#endif
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+                case utf::simd_level::neon: return &clean_run_neon;
+#endif
+                default: return &clean_run_scalar;
+            }
+        }();
+        return k;
+    }
+} // namespace siddiqsoft::json
+
+
+/// @brief SiddiqSoft
+namespace siddiqsoft
+{
+    /// @brief Encoding helpers for REST calls: RFC 3986 percent-encoding, JSON string escaping and base64
+    struct EncodingUtils
+    {
+        using status = utf::transcode_status;
+        using result = utf::transcode_result;
+
+        /// @brief Percent-encodes `src` for use as the URL component `c`. UTF-16/UTF-32/wide input is converted
+        /// to UTF-8 in the same pass; UTF-8 input is encoded byte for byte. Hex digits are upper case.
+        /// @throws std::range_error when UTF-16/UTF-32 input is malformed
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static auto url_encode(std::type_identity_t<std::basic_string_view<S>> src, url_component c = url_component::unreserved)
+                -> std::string
+        {
+            std::string out;
+            url_encode_into<S>(src, out, c);
+            return out;
+        }
+
+
+        /// @brief Percent-encodes `src` and appends the result to `dst`, reusing its capacity.
+        /// On failure `dst` keeps its original contents plus the encoding of the input before the error.
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static void url_encode_into(std::type_identity_t<std::basic_string_view<S>> src,
+                                    std::string&                                     dst,
+                                    url_component                                    c = url_component::unreserved)
+        {
+            constexpr char hex[] = "0123456789ABCDEF";
+
+            const auto& table = url::component_tables[static_cast<size_t>(c)];
+            const auto& k     = url::kernels::get();
+            size_t      o     = dst.size();
+
+            auto room = [&](size_t count) {
+                if (dst.size() - o < count) dst.resize(std::max(o + count, dst.size() * 2));
+            };
+            auto put = [&](const char* s, size_t n) {
+                for (size_t i = 0; i < n;) {
+                    const size_t run = k.safe_run(s + i, n - i, table);
+                    room(run);
+                    std::memcpy(dst.data() + o, s + i, run);
+                    o += run;
+                    i += run;
+                    for (; i < n && !table.allowed[static_cast<unsigned char>(s[i])]; i++) {
+                        room(3);
+                        const auto b = static_cast<unsigned char>(s[i]);
+                        if (c == url_component::form && b == ' ') {
+                            dst[o++] = '+';
+                            continue;
+                        }
+                        dst[o++] = '%';
+                        dst[o++] = hex[b >> 4];
+                        dst[o++] = hex[b & 0x0F];
+                    }
+                }
+            };
+
+            if constexpr (utf::encoding_of<S> == utf::encoding::utf8) {
+                put(utf::as_chars(src.data()), src.size());
+            }
+            else {
+                // ASCII runs are narrowed a block at a time; other code points go through UTF-8 one by one
+                const auto& ascii = utf::ascii_kernels<S>::get();
+                char        block[256];
+                for (size_t i = 0; i < src.size();) {
+                    const size_t run = ascii.narrow(src.data() + i, std::min(src.size() - i, sizeof(block)), block);
+                    put(block, run);
+                    i += run;
+
+                    if (i < src.size() && static_cast<uint32_t>(src[i]) >= 0x80) {
+                        char32_t  cp {};
+                        const int units = utf::decode(src.data() + i, src.size() - i, cp);
+                        if (units <= 0) {
+                            dst.resize(o);
+                            throw std::range_error("EncodingUtils::url_encode - invalid or incomplete sequence");
+                        }
+                        put(block, static_cast<size_t>(utf::encode_utf8(cp, block)));
+                        i += static_cast<size_t>(units);
+                    }
+                }
+            }
+            dst.resize(o);
+        }
+
+
+        /// @brief Decodes the percent-escapes in `src`; `url_component::form` also turns '+' into a space.
+        /// The decoded bytes are returned as they are (normally UTF-8).
+        /// @throws std::range_error when a '%' is not followed by two hexadecimal digits
+        static auto url_decode(std::string_view src, url_component c = url_component::unreserved) -> std::string
+        {
+            std::string out;
+            url_decode_into(src, out, c);
+            return out;
+        }
+
+
+        /// @brief Decodes `src` and appends the result to `dst`, reusing its capacity.
+        /// On failure `dst` keeps its original contents plus the bytes decoded before the error.
+        static void url_decode_into(std::string_view src, std::string& dst, url_component c = url_component::unreserved)
+        {
+            const bool  plus = (c == url_component::form);
+            const auto& k    = url::kernels::get();
+            size_t      o    = dst.size();
+
+            // Decoding never grows the input
+            dst.resize(o + src.size());
+            for (size_t i = 0; i < src.size();) {
+                const size_t run = k.escape_run(src.data() + i, src.size() - i, plus);
+                std::memcpy(dst.data() + o, src.data() + i, run);
+                o += run;
+                i += run;
+                if (i == src.size()) break;
+
+                if (src[i] == '+') {
+                    dst[o++] = ' ';
+                    i++;
+                    continue;
+                }
+
+                const int hi = (src.size() - i >= 3) ? url::hex_value(src[i + 1]) : -1;
+                const int lo = (hi >= 0) ? url::hex_value(src[i + 2]) : -1;
+                if (lo < 0) {
+                    dst.resize(o);
+                    throw std::range_error("EncodingUtils::url_decode - invalid percent escape");
+                }
+                dst[o++] = static_cast<char>((hi << 4) | lo);
+                i += 3;
+            }
+            dst.resize(o);
+        }
+
+
+        /// @brief Escapes `src` for use inside a JSON string (without the surrounding quotes): '"', '\' and
+        /// control characters are escaped, everything else is emitted as UTF-8. UTF-16/UTF-32/wide input is
+        /// converted in the same pass.
+        /// @throws std::range_error when `src` is not well-formed in its encoding
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static auto json_escape(std::type_identity_t<std::basic_string_view<S>> src) -> std::string
+        {
+            std::string out;
+            json_escape_into<S>(src, out);
+            return out;
+        }
+
+
+        /// @brief Escapes `src` and appends the result to `dst`, reusing its capacity.
+        /// On failure `dst` keeps its original contents plus the output for the input before the error.
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static void json_escape_into(std::type_identity_t<std::basic_string_view<S>> src, std::string& dst)
+        {
+            constexpr char hex[] = "0123456789abcdef";
+
+            const auto clean = json::clean_run_kernel();
+            size_t     o     = dst.size();
+
+            auto room = [&](size_t count) {
+                if (dst.size() - o < count) dst.resize(std::max(o + count, dst.size() * 2));
+            };
+            auto put = [&](const char* s, size_t n) {
+                for (size_t i = 0; i < n;) {
+                    const size_t run = clean(s + i, n - i);
+                    room(run + 6);
+                    std::memcpy(dst.data() + o, s + i, run);
+                    o += run;
+                    i += run;
+                    if (i == n) break;
+
+                    const auto b = static_cast<unsigned char>(s[i++]);
+                    dst[o++]     = '\\';
+                    switch (b) {
+                        case '"': dst[o++] = '"'; break;
+                        case '\\': dst[o++] = '\\'; break;
+                        case '\b': dst[o++] = 'b'; break;
+                        case '\f': dst[o++] = 'f'; break;
+                        case '\n': dst[o++] = 'n'; break;
+                        case '\r': dst[o++] = 'r'; break;
+                        case '\t': dst[o++] = 't'; break;
+                        default:
+                            dst[o++] = 'u';
+                            dst[o++] = '0';
+                            dst[o++] = '0';
+                            dst[o++] = hex[b >> 4];
+                            dst[o++] = hex[b & 0x0F];
+                    }
+                }
+            };
+
+            if constexpr (utf::encoding_of<S> == utf::encoding::utf8) {
+                if (auto rc = utf::validate(src.data(), src.size()); rc.status != status::ok) {
+                    throw std::range_error("EncodingUtils::json_escape - invalid or incomplete sequence");
+                }
+                put(utf::as_chars(src.data()), src.size());
+            }
+            else {
+                // ASCII runs are narrowed a block at a time; other code points only need UTF-8 encoding
+                const auto& ascii = utf::ascii_kernels<S>::get();
+                char        block[256];
+                for (size_t i = 0; i < src.size();) {
+                    const size_t run = ascii.narrow(src.data() + i, std::min(src.size() - i, sizeof(block)), block);
+                    put(block, run);
+                    i += run;
+
+                    if (i < src.size() && static_cast<uint32_t>(src[i]) >= 0x80) {
+                        char32_t  cp {};
+                        const int units = utf::decode(src.data() + i, src.size() - i, cp);
+                        if (units <= 0) {
+                            dst.resize(o);
+                            throw std::range_error("EncodingUtils::json_escape - invalid or incomplete sequence");
+                        }
+                        room(4);
+                        o += static_cast<size_t>(utf::encode_utf8(cp, dst.data() + o));
+                        i += static_cast<size_t>(units);
+                    }
+                }
+            }
+            dst.resize(o);
+        }
+
+
+        /// @brief Unescapes the contents of a JSON string (UTF-8, without the surrounding quotes) into D,
+        /// decoding `\uXXXX` escapes (surrogate pairs included) and converting the text in the same pass.
+        /// @throws std::range_error on a malformed escape, an unpaired surrogate, a raw control character or '"',
+        ///         or invalid UTF-8
+        template <typename D = char>
+            requires utf::unicode_char<D>
+        static auto json_unescape(std::string_view src) -> std::basic_string<D>
+        {
+            std::basic_string<D> out;
+            json_unescape_into<D>(src, out);
+            return out;
+        }
+
+
+        /// @brief Unescapes `src` and appends the result to `dst`, reusing its capacity.
+        /// On failure `dst` keeps its original contents plus the output for the input before the error.
+        template <typename D = char>
+            requires utf::unicode_char<D>
+        static void json_unescape_into(std::string_view src, std::basic_string<D>& dst)
+        {
+            const auto clean = json::clean_run_kernel();
+            size_t     o     = dst.size();
+
+            auto fail = [&](const char* what) {
+                dst.resize(o);
+                throw std::range_error(what);
+            };
+            auto hex4 = [&](size_t at) -> int {
+                if (src.size() - at < 4) return -1;
+                int v = 0;
+                for (size_t k = 0; k < 4; k++) {
+                    const int h = url::hex_value(src[at + k]);
+                    if (h < 0) return -1;
+                    v = (v << 4) | h;
+                }
+                return v;
+            };
+
+            // Neither the text (in any encoding) nor the escapes produce more units than they take up
+            dst.resize(o + src.size());
+            for (size_t i = 0; i < src.size();) {
+                const size_t run = clean(src.data() + i, src.size() - i);
+                if (run > 0) {
+                    utf::transcode_result rc {};
+                    if constexpr (utf::encoding_of<D> == utf::encoding::utf8) {
+                        // UTF-8 to UTF-8 is a plain copy so it has to be validated separately
+                        rc = utf::validate(src.data() + i, run);
+                        std::memcpy(dst.data() + o, src.data() + i, run);
+                        rc.written = run;
+                    }
+                    else {
+                        rc = utf::transcode(src.data() + i, run, dst.data() + o, dst.size() - o);
+                    }
+                    if (rc.status != status::ok) fail("EncodingUtils::json_unescape - invalid or incomplete sequence");
+                    o += rc.written;
+                    i += run;
+                    if (i == src.size()) break;
+                }
+
+                if (src[i] != '\\' || src.size() - i < 2) fail("EncodingUtils::json_unescape - unescaped control character or quote");
+
+                char32_t cp {};
+                switch (src[i + 1]) {
+                    case '"': cp = '"'; break;
+                    case '\\': cp = '\\'; break;
+                    case '/': cp = '/'; break;
+                    case 'b': cp = '\b'; break;
+                    case 'f': cp = '\f'; break;
+                    case 'n': cp = '\n'; break;
+                    case 'r': cp = '\r'; break;
+                    case 't': cp = '\t'; break;
+                    case 'u': {
+                        const int u = hex4(i + 2);
+                        if (u < 0) fail("EncodingUtils::json_unescape - malformed \\u escape");
+                        cp = static_cast<char32_t>(u);
+                        if (cp >= 0xDC00 && cp <= 0xDFFF) fail("EncodingUtils::json_unescape - unpaired surrogate");
+                        if (cp >= 0xD800 && cp <= 0xDBFF) {
+                            const int lo = (src.substr(i + 6, 2) == "\\u") ? hex4(i + 8) : -1;
+                            if (lo < 0xDC00 || lo > 0xDFFF) fail("EncodingUtils::json_unescape - unpaired surrogate");
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (static_cast<char32_t>(lo) - 0xDC00);
+                            i += 6;
+                        }
+                        i += 4;
+                        break;
+                    }
+                    default: fail("EncodingUtils::json_unescape - invalid escape");
+                }
+                i += 2;
+                o += static_cast<size_t>(utf::encode(cp, dst.data() + o));
+            }
+            dst.resize(o);
+        }
+
+
+        /// @brief Number of characters base64 encoding `n` bytes produces
+        static constexpr auto base64_encoded_length(size_t n, bool padded = true) noexcept -> size_t
+        {
+            return padded ? (n + 2) / 3 * 4 : n / 3 * 4 + (n % 3 == 0 ? 0 : n % 3 + 1);
+        }
+
+
+        /// @brief Number of bytes decoding `src` produces, from its length and padding; the characters are not checked.
+        static constexpr auto base64_decoded_length(std::string_view src) noexcept -> size_t
+        {
+            size_t n = src.size();
+            for (int k = 0; k < 2 && n > 0 && src[n - 1] == '='; k++) n--;
+            return n / 4 * 3 + (n % 4 > 1 ? n % 4 - 1 : 0);
+        }
+
+
+        /// @brief Base64 encodes `src` into `dst` without allocating.
+        /// @return `output_too_small` (nothing written) unless `dst` holds `base64_encoded_length(src.size(), padded)` characters
+        static auto base64_encode(std::span<const uint8_t> src,
+                                  std::span<char>          dst,
+                                  base64_variant           v      = base64_variant::standard,
+                                  bool                     padded = true) noexcept -> result
+        {
+            return base64_encode(src, dst, v, padded, base64::kernels::get());
+        }
+
+
+        /// @brief Base64 encodes the bytes of `src` into a new string
+        static auto base64_encode(std::span<const uint8_t> src, base64_variant v = base64_variant::standard, bool padded = true)
+                -> std::string
+        {
+            std::string out(base64_encoded_length(src.size(), padded), '\0');
+            base64_encode(src, out, v, padded);
+            return out;
+        }
+
+
+        /// @brief Base64 encodes the bytes of `src` (for example an HMAC digest held in a std::string)
+        static auto base64_encode(std::string_view src, base64_variant v = base64_variant::standard, bool padded = true) -> std::string
+        {
+            return base64_encode(std::span<const uint8_t> {reinterpret_cast<const uint8_t*>(src.data()), src.size()}, v, padded);
+        }
+
+
+        /// @brief Decodes base64 `src` into `dst` without allocating.
+        /// @return `written` bytes on success; otherwise `invalid_sequence` with `consumed` at the offending
+        ///         character, `incomplete_sequence` for a truncated group or missing padding, or `output_too_small`
+        ///         (nothing written) unless `dst` holds `base64_decoded_length(src)` bytes.
+        static auto base64_decode(std::string_view    src,
+                                  std::span<uint8_t>  dst,
+                                  base64_variant      v = base64_variant::standard,
+                                  base64_padding      p = base64_padding::strict) noexcept -> result
+        {
+            return base64_decode(src, dst, v, p, base64::kernels::get());
+        }
+
+
+        /// @brief Decodes base64 `src` into a new string of bytes
+        /// @throws std::range_error when `src` is not valid base64 under `v` and `p`
+        static auto base64_decode(std::string_view src, base64_variant v = base64_variant::standard, base64_padding p = base64_padding::strict)
+                -> std::string
+        {
+            std::string out(base64_decoded_length(src), '\0');
+            auto        rc = base64_decode(src, std::span<uint8_t> {reinterpret_cast<uint8_t*>(out.data()), out.size()}, v, p);
+            if (rc.status != status::ok) throw std::range_error("EncodingUtils::base64_decode - invalid base64");
+            return out;
+        }
+
+
+        /// @brief base64_encode with the given block kernels (used by the benchmarks to compare against scalar)
+        static auto base64_encode(std::span<const uint8_t> src, std::span<char> dst, base64_variant v, bool padded, const base64::kernels& k) noexcept
+                -> result
+        {
+            const size_t need = base64_encoded_length(src.size(), padded);
+            if (dst.size() < need) return {0, 0, status::output_too_small};
+
+            const bool   url      = (v == base64_variant::url);
+            const char*  alphabet = url ? base64::url_alphabet : base64::standard_alphabet;
+            const size_t i        = k.encode(src.data(), src.size(), dst.data(), url);
+            size_t       o        = i / 3 * 4;
+
+            if (const size_t rest = src.size() - i; rest > 0) {
+                const uint32_t b = (uint32_t {src[i]} << 16) | (rest > 1 ? uint32_t {src[i + 1]} << 8 : 0);
+                dst[o++]         = alphabet[(b >> 18) & 0x3F];
+                dst[o++]         = alphabet[(b >> 12) & 0x3F];
+                if (rest > 1) dst[o++] = alphabet[(b >> 6) & 0x3F];
+                if (padded) {
+                    dst[o++] = '=';
+                    if (rest == 1) dst[o++] = '=';
+                }
+            }
+            return {o, src.size(), status::ok};
+        }
+
+
+        /// @brief base64_decode with the given block kernels (used by the benchmarks to compare against scalar)
+        static auto base64_decode(std::string_view src, std::span<uint8_t> dst, base64_variant v, base64_padding p, const base64::kernels& k) noexcept
+                -> result
+        {
+            const bool  url   = (v == base64_variant::url);
+            const auto& table = url ? base64::url_table : base64::standard_table;
+
+            // Split off the padding
+            size_t n = src.size();
+            while (n > 0 && src.size() - n < 2 && src[n - 1] == '=') n--;
+            const size_t pads = src.size() - n;
+            if (pads > 0 && src.size() % 4 != 0) return {0, n, status::invalid_sequence};
+            if (p == base64_padding::strict && src.size() % 4 != 0) return {0, src.size(), status::incomplete_sequence};
+            if (n % 4 == 1) return {0, n - 1, status::incomplete_sequence};
+            if (dst.size() < base64_decoded_length(src)) return {0, 0, status::output_too_small};
+
+            const size_t i = k.decode(src.data(), n, dst.data(), dst.size(), url);
+            size_t       o = i / 4 * 3;
+
+            // The block kernels stop in front of a bad character; find it, then decode the final partial group
+            const size_t whole = n / 4 * 4;
+            for (size_t j = i; j < n; j++) {
+                if (table.value[static_cast<unsigned char>(src[j])] < 0) return {o, j, status::invalid_sequence};
+            }
+            if (i < whole) return {o, i, status::invalid_sequence};
+
+            if (const size_t rest = n - whole; rest > 0) {
+                uint32_t bits {0};
+                for (size_t j = 0; j < rest; j++) bits = (bits << 6) | static_cast<uint32_t>(table.value[static_cast<unsigned char>(src[whole + j])]);
+                // 2 characters carry 12 bits (one byte + 4 spare), 3 carry 18 (two bytes + 2 spare)
+                const uint32_t spare = (rest == 2) ? 4 : 2;
+                if (p == base64_padding::strict && (bits & ((1u << spare) - 1)) != 0) return {o, n - 1, status::invalid_sequence};
+                bits >>= spare;
+                if (rest == 3) dst[o++] = static_cast<uint8_t>(bits >> 8);
+                dst[o++] = static_cast<uint8_t>(bits);
+            }
+            return {o, src.size(), status::ok};
+        }
+    };
+} // namespace siddiqsoft
+
+#endif
@@ -0,0 +1,618 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifndef FILE_UTILS_HPP
+#define FILE_UTILS_HPP
+
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "conversion-utils.hpp"
+
+
+/// @brief SiddiqSoft
+namespace siddiqsoft
+{
+    /// @brief The encodings FileUtils reads and writes
+    enum class file_encoding
+    {
+        utf8,
+        utf16le,
+        utf16be,
+        utf32le,
+        utf32be,
+        cp1252 // Windows-1252; the fallback for text that is none of the above
+    };
+
+
+    /// @brief What FileUtils::detect_encoding found
+    struct encoding_detection
+    {
+        file_encoding encoding {file_encoding::utf8};
+        std::size_t   bom_length {0}; // 0 when the encoding was guessed from the content
+    };
+
+
+    /// @brief Options for FileUtils::transcode_file
+    struct file_transcode_options
+    {
+        file_encoding                to {file_encoding::utf8};
+        std::optional<file_encoding> from {};           // detected from the BOM or the content when empty
+        bool                         write_bom {false}; // start the output with U+FEFF
+        std::size_t                  chunk_bytes {std::size_t {1} << 20};
+    };
+
+
+    /// @brief The outcome of FileUtils::transcode_file. On failure (error_policy::report) `consumed` is the
+    /// byte offset of the offending sequence and `written` counts the output before it.
+    struct file_transcode_result
+    {
+        file_encoding         from {file_encoding::utf8};
+        std::size_t           bom_length {0};
+        std::uint64_t         consumed {0}; // input bytes, including the BOM
+        std::uint64_t         written {0};  // output bytes, including the BOM
+        utf::transcode_status status {utf::transcode_status::ok};
+    };
+
+
+    /// @brief A read-only memory map of a whole file, with a hint to drop pages that have been processed.
+    /// Mapped pages are backed by the file itself, so reading a file sequentially and releasing behind
+    /// the read position keeps the resident set flat regardless of the file size.
+    class mapped_file
+    {
+    public:
+        /// @throws std::system_error when the file cannot be opened or mapped
+        explicit mapped_file(const std::filesystem::path& path)
+        {
+#if defined(_WIN32)
+            HANDLE file = ::CreateFileW(path.c_str(),
+                                        GENERIC_READ,
+                                        FILE_SHARE_READ,
+                                        nullptr,
+                                        OPEN_EXISTING,
+                                        FILE_FLAG_SEQUENTIAL_SCAN,
+                                        nullptr);
+            if (file == INVALID_HANDLE_VALUE) fail("mapped_file - open");
+
+            LARGE_INTEGER size {};
+            if (!::GetFileSizeEx(file, &size)) {
+                const DWORD e = ::GetLastError();
+                ::CloseHandle(file);
+                fail("mapped_file - size", e);
+            }
+            length = static_cast<std::size_t>(size.QuadPart);
+
+            if (length > 0) {
+                HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                DWORD  e       = ::GetLastError();
+                ::CloseHandle(file);
+                if (mapping == nullptr) fail("mapped_file - map", e);
+                view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                e    = ::GetLastError();
+                ::CloseHandle(mapping);
+                if (view == nullptr) fail("mapped_file - map", e);
+            }
+            else {
+                ::CloseHandle(file);
+            }
+#else
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) fail("mapped_file - open");
+
+            struct stat st {};
+            if (::fstat(fd, &st) != 0) {
+                const int e = errno;
+                ::close(fd);
+                fail("mapped_file - size", e);
+            }
+            length = static_cast<std::size_t>(st.st_size);
+
+            if (length > 0) {
+                view = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                const int e = errno;
+                ::close(fd);
+                if (view == MAP_FAILED) {
+                    view = nullptr;
+                    fail("mapped_file - map", e);
+                }
+                ::madvise(view, length, MADV_SEQUENTIAL);
+            }
+            else {
+                ::close(fd);
+            }
+#endif
+        }
+
+        mapped_file(const mapped_file&)            = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        mapped_file(mapped_file&& src) noexcept
+            : view(std::exchange(src.view, nullptr))
+            , length(std::exchange(src.length, 0))
+            , released(std::exchange(src.released, 0))
+        {
+        }
+
+        mapped_file& operator=(mapped_file&& src) noexcept
+        {
+            if (this != &src) {
+                unmap();
+                view     = std::exchange(src.view, nullptr);
+                length   = std::exchange(src.length, 0);
+                released = std::exchange(src.released, 0);
+            }
+            return *this;
+        }
+
+        ~mapped_file() { unmap(); }
+
+        [[nodiscard]] auto data() const noexcept -> const std::byte* { return static_cast<const std::byte*>(view); }
+        [[nodiscard]] auto size() const noexcept -> std::size_t { return length; }
+        [[nodiscard]] auto bytes() const noexcept -> std::span<const std::byte> { return {data(), length}; }
+
+        /// @brief Hints that the bytes before `upto` will not be read again; their whole pages are dropped
+        /// from memory (reading them again faults them back in from the file).
+        void release(std::size_t upto) noexcept
+        {
+            upto = std::min(upto, length);
+            const std::size_t end = upto - upto % page_size();
+            if (end <= released) return;
+#if defined(_WIN32)
+            // Unlocking pages that are not locked removes them from the working set
+            ::VirtualUnlock(static_cast<std::byte*>(view) + released, end - released);
+#else
+            ::madvise(static_cast<std::byte*>(view) + released, end - released, MADV_DONTNEED);
+#endif
+            released = end;
+        }
+
+    private:
+        void*       view {nullptr};
+        std::size_t length {0};
+        std::size_t released {0};
+
+        static auto page_size() noexcept -> std::size_t
+        {
+#if defined(_WIN32)
+            static const std::size_t size = [] {
+                SYSTEM_INFO info {};
+                ::GetSystemInfo(&info);
+                return static_cast<std::size_t>(info.dwPageSize);
+            }();
+#else
+            static const std::size_t size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+            return size;
+        }
+
+        void unmap() noexcept
+        {
+            if (view == nullptr) return;
+#if defined(_WIN32)
+            ::UnmapViewOfFile(view);
+#else
+            ::munmap(view, length);
+#endif
+            view = nullptr;
+        }
+
+#if defined(_WIN32)
+        [[noreturn]] static void fail(const char* what, DWORD e = ::GetLastError())
+        {
+            throw std::system_error(static_cast<int>(e), std::system_category(), what);
+        }
+#else
+        [[noreturn]] static void fail(const char* what, int e = errno)
+        {
+            throw std::system_error(e, std::generic_category(), what);
+        }
+#endif
+    };
+
+
+    /// @brief Re-encodes whole files: the input is memory mapped, its encoding detected from the BOM (or
+    /// guessed from the content), and the output streamed to a file descriptor in bounded chunks. Memory
+    /// use is set by the chunk size, not the file size.
+    struct FileUtils
+    {
+        /// @brief Bytes of content examined when there is no BOM
+        static constexpr std::size_t sample_bytes = 64 * 1024;
+
+        /// @brief Detects the encoding of `head`, the start of a file. A UTF-8, UTF-16 or UTF-32 BOM decides;
+        /// without one, a sample of up to `sample_bytes` is tried as UTF-32 (every 4-byte unit a code point),
+        /// then UTF-16 (NUL high bytes on one side only, as in mostly-Latin text), then UTF-8. Anything else is
+        /// taken to be Windows-1252.
+        static auto detect_encoding(std::span<const std::byte> head) noexcept -> encoding_detection
+        {
+            const auto byte = [&](std::size_t k) { return std::to_integer<std::uint32_t>(head[k]); };
+            const auto n    = head.size();
+
+            // UTF-32LE is tested before UTF-16LE, whose BOM it starts with
+            if (n >= 4 && byte(0) == 0xFF && byte(1) == 0xFE && byte(2) == 0 && byte(3) == 0) return {file_encoding::utf32le, 4};
+            if (n >= 4 && byte(0) == 0 && byte(1) == 0 && byte(2) == 0xFE && byte(3) == 0xFF) return {file_encoding::utf32be, 4};
+            if (n >= 3 && byte(0) == 0xEF && byte(1) == 0xBB && byte(2) == 0xBF) return {file_encoding::utf8, 3};
+            if (n >= 2 && byte(0) == 0xFF && byte(1) == 0xFE) return {file_encoding::utf16le, 2};
+            if (n >= 2 && byte(0) == 0xFE && byte(1) == 0xFF) return {file_encoding::utf16be, 2};
+
+            const auto sample    = head.first(std::min(n, sample_bytes));
+            const bool truncated = sample.size() < n;
+            if (sample.empty()) return {file_encoding::utf8, 0};
+
+            if (looks_utf32(sample, true)) return {file_encoding::utf32le, 0};
+            if (looks_utf32(sample, false)) return {file_encoding::utf32be, 0};
+            if (looks_utf16(sample, true, truncated)) return {file_encoding::utf16le, 0};
+            if (looks_utf16(sample, false, truncated)) return {file_encoding::utf16be, 0};
+
+            const auto rc = utf::validate(reinterpret_cast<const char*>(sample.data()), sample.size());
+            // A sample cut short may end inside a sequence
+            if (rc.status == utf::transcode_status::ok ||
+                (truncated && rc.status == utf::transcode_status::incomplete_sequence && sample.size() - rc.consumed < 4))
+                return {file_encoding::utf8, 0};
+
+            return {file_encoding::cp1252, 0};
+        }
+
+
+        /// @brief Transcodes the file `src` into `opt.to` and writes it to the open file descriptor `fd`,
+        /// `opt.chunk_bytes` of input at a time.
+        /// @tparam P What to do with malformed input; under `throw_error` the output before the error is written.
+        /// @throws std::system_error on I/O errors; std::range_error on malformed input (throw_error only);
+        ///         std::invalid_argument when `opt.to` is not a Unicode encoding.
+        template <error_policy P = error_policy::throw_error>
+        static auto transcode_file(const std::filesystem::path& src, int fd, const file_transcode_options& opt = {})
+                -> file_transcode_result
+        {
+            check_output(opt.to);
+            mapped_file in {src};
+            return transcode<P>(in, fd, opt);
+        }
+
+
+        /// @brief Transcodes the file `src` into the file `dst`, which is created or truncated only once `src`
+        /// has been opened and `opt.to` accepted
+        template <error_policy P = error_policy::throw_error>
+        static auto transcode_file(const std::filesystem::path& src, const std::filesystem::path& dst, const file_transcode_options& opt = {})
+                -> file_transcode_result
+        {
+            check_output(opt.to);
+            mapped_file in {src};
+
+            struct output
+            {
+                int fd {-1};
+                ~output()
+                {
+#if defined(_WIN32)
+                    if (fd >= 0) ::_close(fd);
+#else
+                    if (fd >= 0) ::close(fd);
+#endif
+                }
+            } out;
+
+#if defined(_WIN32)
+            out.fd = ::_wopen(dst.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+            out.fd = ::open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+#endif
+            if (out.fd < 0) throw std::system_error(errno, std::generic_category(), "FileUtils::transcode_file - open");
+
+            return transcode<P>(in, out.fd, opt);
+        }
+
+    private:
+        /// @brief Throws std::invalid_argument unless `to` is UTF-8, UTF-16 or UTF-32
+        static void check_output(file_encoding to)
+        {
+            switch (to) {
+                case file_encoding::utf8:
+                case file_encoding::utf16le:
+                case file_encoding::utf16be:
+                case file_encoding::utf32le:
+                case file_encoding::utf32be: return;
+                default: throw std::invalid_argument("FileUtils::transcode_file - the output must be UTF-8, UTF-16 or UTF-32");
+            }
+        }
+
+
+        template <error_policy P>
+        static auto transcode(mapped_file& in, int fd, const file_transcode_options& opt) -> file_transcode_result
+        {
+            file_transcode_result res {};
+            if (opt.from) {
+                const auto bom = detect_encoding(in.bytes());
+                res.from       = *opt.from;
+                res.bom_length = (bom.encoding == res.from) ? bom.bom_length : 0;
+            }
+            else {
+                const auto found = detect_encoding(in.bytes());
+                res.from         = found.encoding;
+                res.bom_length   = found.bom_length;
+            }
+            res.consumed = res.bom_length;
+
+            switch (opt.to) {
+                case file_encoding::utf8: from<char, P>(in, fd, opt, false, res); break;
+                case file_encoding::utf16le: from<char16_t, P>(in, fd, opt, std::endian::native != std::endian::little, res); break;
+                case file_encoding::utf16be: from<char16_t, P>(in, fd, opt, std::endian::native != std::endian::big, res); break;
+                case file_encoding::utf32le: from<char32_t, P>(in, fd, opt, std::endian::native != std::endian::little, res); break;
+                case file_encoding::utf32be: from<char32_t, P>(in, fd, opt, std::endian::native != std::endian::big, res); break;
+                default: check_output(opt.to);
+            }
+            return res;
+        }
+
+
+        static auto looks_utf32(std::span<const std::byte> s, bool little) noexcept -> bool
+        {
+            if (s.size() % 4 != 0) return false;
+            for (std::size_t k = 0; k < s.size(); k += 4) {
+                std::uint32_t cp {0};
+                for (std::size_t b = 0; b < 4; b++) {
+                    cp = (cp << 8) | std::to_integer<std::uint32_t>(s[little ? k + 3 - b : k + b]);
+                }
+                if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return false;
+            }
+            return true;
+        }
+
+        static auto looks_utf16(std::span<const std::byte> s, bool little, bool truncated) noexcept -> bool
+        {
+            const std::size_t units = s.size() / 2;
+            if (units == 0 || (s.size() % 2 != 0 && !truncated)) return false;
+
+            std::size_t zeroHigh {0}, zeroLow {0};
+            bool        pendingHigh {false};
+            for (std::size_t k = 0; k < units; k++) {
+                const auto hi = std::to_integer<std::uint32_t>(s[2 * k + (little ? 1 : 0)]);
+                const auto lo = std::to_integer<std::uint32_t>(s[2 * k + (little ? 0 : 1)]);
+                zeroHigh += (hi == 0);
+                zeroLow += (lo == 0);
+
+                const bool high = (hi & 0xFC) == 0xD8, low = (hi & 0xFC) == 0xDC;
+                if (low != pendingHigh) return false;
+                pendingHigh = high;
+            }
+            if (pendingHigh && !truncated) return false;
+
+            // Latin text has a NUL in (nearly) every high byte; NUL low bytes are rare in any text
+            return zeroHigh * 4 >= units && zeroLow * 8 < zeroHigh;
+        }
+
+        /// @brief Units of D, swapped to the other byte order in place
+        template <typename D>
+        static void byteswap(D* d, std::size_t n) noexcept
+        {
+            for (std::size_t k = 0; k < n; k++) {
+                if constexpr (sizeof(D) == 1) {
+                    return;
+                }
+                else if constexpr (sizeof(D) == 2) {
+                    const auto u = static_cast<std::uint16_t>(d[k]);
+                    d[k]         = static_cast<D>(static_cast<std::uint16_t>((u << 8) | (u >> 8)));
+                }
+                else {
+                    const auto u = static_cast<std::uint32_t>(d[k]);
+                    d[k] = static_cast<D>((u << 24) | ((u << 8) & 0x00FF0000u) | ((u >> 8) & 0x0000FF00u) | (u >> 24));
+                }
+            }
+        }
+
+        static void write_all(int fd, const void* data, std::size_t n)
+        {
+            auto p = static_cast<const char*>(data);
+            while (n > 0) {
+#if defined(_WIN32)
+                const int w = ::_write(fd, p, static_cast<unsigned>(std::min<std::size_t>(n, 1u << 30)));
+#else
+                const auto w = ::write(fd, p, n);
+#endif
+                if (w < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::system_error(errno, std::generic_category(), "FileUtils::transcode_file - write");
+                }
+                p += w;
+                n -= static_cast<std::size_t>(w);
+            }
+        }
+
+        /// @brief Selects the source unit type (or codepage) for output in D
+        template <typename D, error_policy P>
+        static void from(mapped_file& in, int fd, const file_transcode_options& opt, bool swapOut, file_transcode_result& res)
+        {
+            constexpr bool littleHost = std::endian::native == std::endian::little;
+            switch (res.from) {
+                case file_encoding::utf8: pump<char, D, P>(in, fd, opt, false, swapOut, res); break;
+                case file_encoding::utf16le: pump<char16_t, D, P>(in, fd, opt, !littleHost, swapOut, res); break;
+                case file_encoding::utf16be: pump<char16_t, D, P>(in, fd, opt, littleHost, swapOut, res); break;
+                case file_encoding::utf32le: pump<char32_t, D, P>(in, fd, opt, !littleHost, swapOut, res); break;
+                case file_encoding::utf32be: pump<char32_t, D, P>(in, fd, opt, littleHost, swapOut, res); break;
+                case file_encoding::cp1252: pump<codepage::cp1252, D, P>(in, fd, opt, false, swapOut, res); break;
+            }
+        }
+
+        /// @brief Appends `n` units of S (UTF or, for a codepage tag, bytes) converted to D to `out`
+        template <typename S, typename U, typename D, error_policy P>
+        static auto convert_chunk(const U* s, std::size_t n, std::basic_string<D>& out) -> utf::transcode_result
+        {
+            if constexpr (codepage::single_byte<S>) {
+                // Bytes the codepage leaves undefined are substituted by U+FFFD whatever the policy
+                std::size_t i {0}, o {0};
+                out.resize(codepage::decoded_length<D>(S::table, s, n));
+                while (true) {
+                    auto rc = codepage::decode(S::table, s + i, n - i, out.data() + o, out.size() - o);
+                    i += rc.consumed;
+                    o += rc.written;
+                    if (rc.status == utf::transcode_status::ok) break;
+                    utf::write_replacement(out.data() + o);
+                    o += utf::replacement_length<D>;
+                    i++;
+                }
+                out.resize(o);
+                return {o, i, utf::transcode_status::ok};
+            }
+            else if constexpr (utf::encoding_of<S> == utf::encoding_of<D>) {
+                // Same encoding: validated and copied as it is
+                std::size_t i {0};
+                while (true) {
+                    auto rc = utf::validate(s + i, n - i);
+                    out.append(reinterpret_cast<const D*>(s + i), rc.consumed);
+                    i += rc.consumed;
+                    if (rc.status == utf::transcode_status::ok) return {out.size(), i, rc.status};
+                    if constexpr (P == error_policy::report) return {out.size(), i, rc.status};
+                    if constexpr (P == error_policy::replace) {
+                        D fffd[utf::replacement_length<D>];
+                        utf::write_replacement(fffd);
+                        out.append(fffd, utf::replacement_length<D>);
+                    }
+                    i += utf::invalid_length(s + i, n - i);
+                }
+            }
+            else {
+                return ConversionUtils::convert_into<S, D, P>(std::basic_string_view<S> {s, n}, out);
+            }
+        }
+
+        template <typename S, typename D, error_policy P>
+        static void pump(mapped_file& in, int fd, const file_transcode_options& opt, bool swapIn, bool swapOut, file_transcode_result& res)
+        {
+            using unit = std::conditional_t<codepage::single_byte<S>, char, S>;
+            // Malformed input is reported by the chunk conversion and thrown (or returned) here
+            constexpr auto policy = (P == error_policy::throw_error) ? error_policy::report : P;
+
+            std::basic_string<D> out;
+            const auto           flush = [&] {
+                if (swapOut) byteswap(out.data(), out.size());
+                write_all(fd, out.data(), out.size() * sizeof(D));
+                res.written += out.size() * sizeof(D);
+                out.clear();
+            };
+
+            if (opt.write_bom) {
+                if constexpr (utf::encoding_of<D> == utf::encoding::utf8) out.assign({D(0xEF), D(0xBB), D(0xBF)});
+                else out.assign(1, D(0xFEFF));
+                flush();
+            }
+
+            const std::size_t offset = res.bom_length;
+            const auto        units  = reinterpret_cast<const unit*>(in.data() + offset);
+            const std::size_t count  = (in.size() - offset) / sizeof(unit);
+            const std::size_t step   = std::max<std::size_t>(opt.chunk_bytes / sizeof(unit), 4);
+
+            std::basic_string<unit> swapped;
+            for (std::size_t pos = 0; pos < count;) {
+                const unit* chunk {units + pos};
+                std::size_t n {};
+                if (swapIn) {
+                    // One unit past the step, in case the cut lands on a low surrogate
+                    swapped.assign(units + pos, std::min(count - pos, step + 1));
+                    byteswap(swapped.data(), swapped.size());
+                    chunk = swapped.data();
+                    n     = utf::split_point(chunk, swapped.size(), step);
+                }
+                else if constexpr (codepage::single_byte<S>) {
+                    n = std::min(count - pos, step);
+                }
+                else {
+                    n = utf::split_point(units, count, pos + step) - pos;
+                }
+
+                const auto rc = convert_chunk<S, unit, D, policy>(chunk, n, out);
+                flush();
+                res.consumed = offset + (pos + rc.consumed) * sizeof(unit);
+                if (rc.status != utf::transcode_status::ok) {
+                    res.status = rc.status;
+                    if constexpr (P == error_policy::throw_error) {
+                        throw std::range_error("FileUtils::transcode_file - invalid or incomplete sequence");
+                    }
+                    return;
+                }
+                pos += n;
+                in.release(res.consumed);
+            }
+
+            // A file cut in the middle of a UTF-16 or UTF-32 code unit
+            if (offset + count * sizeof(unit) < in.size()) {
+                if constexpr (P == error_policy::throw_error) {
+                    throw std::range_error("FileUtils::transcode_file - invalid or incomplete sequence");
+                }
+                else if constexpr (P == error_policy::report) {
+                    res.status = utf::transcode_status::incomplete_sequence;
+                    return;
+                }
+                else if constexpr (P == error_policy::replace) {
+                    out.resize(utf::replacement_length<D>);
+                    utf::write_replacement(out.data());
+                    flush();
+                }
+                res.consumed = in.size();
+            }
+        }
+    };
+} // namespace siddiqsoft
+
+#endif
@@ -0,0 +1,177 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifndef FORMAT_UTILS_HPP
+#define FORMAT_UTILS_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#if __has_include(<format>)
+#include <format>
+#endif
+
+#include "utf-transcoder.hpp"
+
+
+/// @brief SiddiqSoft
+namespace siddiqsoft
+{
+    /// @brief Text in any Unicode encoding, written out as UTF-8 by `operator<<` and `std::format`; see as_utf8.
+    /// Holds a view: the text must outlive the wrapper.
+    template <utf::unicode_char S>
+    struct utf8_text
+    {
+        std::basic_string_view<S> text;
+    };
+
+
+    /// @brief Wraps `src` so that streaming or formatting it transcodes straight into the output, without a
+    /// temporary std::string:
+    /// @code
+    ///     std::format("user={}", as_utf8(wideName));
+    ///     std::clog << as_utf8(wideName);
+    /// @endcode
+    template <utf::unicode_char S>
+    constexpr auto as_utf8(std::basic_string_view<S> src) noexcept -> utf8_text<S>
+    {
+        return {src};
+    }
+
+    template <utf::unicode_char S, typename T, typename A>
+    constexpr auto as_utf8(const std::basic_string<S, T, A>& src) noexcept -> utf8_text<S>
+    {
+        return {{src.data(), src.size()}};
+    }
+
+    template <utf::unicode_char S>
+    constexpr auto as_utf8(const S* src) noexcept -> utf8_text<S>
+    {
+        return {std::basic_string_view<S> {src}};
+    }
+
+
+    namespace formatting
+    {
+        /// @brief Transcodes `src` to UTF-8 through a fixed stack buffer and hands every block to
+        /// `sink(const char*, size_t)`. UTF-8 input is validated and passed through without copying.
+        /// Logging must not throw on bad input, so each maximal invalid subpart is written as U+FFFD.
+        template <utf::unicode_char S, typename Sink>
+        inline void write_utf8(std::basic_string_view<S> src, Sink&& sink)
+        {
+            static constexpr char fffd[] {'\xEF', '\xBF', '\xBD'};
+
+            std::size_t i {0};
+            while (i < src.size()) {
+                utf::transcode_result rc {};
+                if constexpr (utf::encoding_of<S> == utf::encoding::utf8) {
+                    rc = utf::validate(src.data() + i, src.size() - i);
+                    if (rc.consumed > 0) sink(reinterpret_cast<const char*>(src.data() + i), rc.consumed);
+                }
+                else {
+                    char block[1024];
+                    rc = utf::transcode(src.data() + i, src.size() - i, block, sizeof(block));
+                    if (rc.written > 0) sink(block, rc.written);
+                }
+                i += rc.consumed;
+
+                if (rc.status == utf::transcode_status::invalid_sequence || rc.status == utf::transcode_status::incomplete_sequence) {
+                    sink(fffd, sizeof(fffd));
+                    i += utf::invalid_length(src.data() + i, src.size() - i);
+                }
+            }
+        }
+    } // namespace formatting
+
+
+    /// @brief Writes `src` to `os` as UTF-8, block by block. A field width set on the stream (std::setw)
+    /// is honoured by converting the text first.
+    template <utf::unicode_char S>
+    inline auto operator<<(std::ostream& os, utf8_text<S> src) -> std::ostream&
+    {
+        if (os.width() != 0) {
+            std::string padded;
+            formatting::write_utf8(src.text, [&](const char* p, std::size_t n) { padded.append(p, n); });
+            return os << padded;
+        }
+
+        formatting::write_utf8(src.text, [&](const char* p, std::size_t n) { os.write(p, static_cast<std::streamsize>(n)); });
+        return os;
+    }
+} // namespace siddiqsoft
+
+
+#if defined(__cpp_lib_format)
+namespace std
+{
+    /// @brief `std::format("{}", as_utf8(src))` transcodes into the format output iterator. A format spec
+    /// (width, fill, precision) is applied as for std::string_view, by converting the text first.
+    template <siddiqsoft::utf::unicode_char S>
+    struct formatter<siddiqsoft::utf8_text<S>, char>
+    {
+        constexpr auto parse(std::format_parse_context& ctx) -> std::format_parse_context::iterator
+        {
+            plain = (ctx.begin() == ctx.end() || *ctx.begin() == '}');
+            return plain ? ctx.begin() : padded.parse(ctx);
+        }
+
+        template <typename FormatContext>
+        auto format(siddiqsoft::utf8_text<S> src, FormatContext& ctx) const -> typename FormatContext::iterator
+        {
+            if (plain) {
+                auto out = ctx.out();
+                siddiqsoft::formatting::write_utf8(src.text, [&](const char* p, std::size_t n) { out = std::copy_n(p, n, out); });
+                return out;
+            }
+
+            std::string text;
+            siddiqsoft::formatting::write_utf8(src.text, [&](const char* p, std::size_t n) { text.append(p, n); });
+            return padded.format(std::string_view {text}, ctx);
+        }
+
+    private:
+        bool                                   plain {true};
+        std::formatter<std::string_view, char> padded;
+    };
+} // namespace std
+#endif
+
+#endif
@@ -0,0 +1,431 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifndef NORMALIZATION_UTILS_HPP
+#define NORMALIZATION_UTILS_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "normalization-tables.hpp"
+#include "utf-transcoder.hpp"
+
+
+/// @brief SiddiqSoft
+namespace siddiqsoft
+{
+    /// @brief Unicode normalization forms supported by NormalizationUtils
+    enum class normalization_form
+    {
+        nfc, ///< Canonical decomposition followed by canonical composition
+        nfd  ///< Canonical decomposition
+    };
+} // namespace siddiqsoft
+
+
+/// @brief Table lookups, Hangul arithmetic and quick-check kernels used by NormalizationUtils
+namespace siddiqsoft::normalization
+{
+    /// @brief Canonical combining class and quick-check flags of `cp`
+    inline const property& lookup(char32_t cp) noexcept
+    {
+        const unsigned block = stage1[cp >> stage_shift];
+        return properties[stage2[(block << stage_shift) | (cp & ((1u << stage_shift) - 1))]];
+    }
+
+
+    // Hangul syllables decompose and compose arithmetically (Unicode chapter 3.12)
+    inline constexpr char32_t hangul_s_base  = 0xAC00;
+    inline constexpr char32_t hangul_l_base  = 0x1100;
+    inline constexpr char32_t hangul_v_base  = 0x1161;
+    inline constexpr char32_t hangul_t_base  = 0x11A7;
+    inline constexpr char32_t hangul_l_count = 19;
+    inline constexpr char32_t hangul_v_count = 21;
+    inline constexpr char32_t hangul_t_count = 28;
+    inline constexpr char32_t hangul_n_count = hangul_v_count * hangul_t_count;
+    inline constexpr char32_t hangul_s_count = hangul_l_count * hangul_n_count;
+
+
+    /// @brief Appends the full canonical decomposition of `cp` (or `cp` itself) to `out`
+    inline void decompose(char32_t cp, std::u32string& out)
+    {
+        if (cp - hangul_s_base < hangul_s_count) {
+            const char32_t s = cp - hangul_s_base;
+            out += hangul_l_base + s / hangul_n_count;
+            out += hangul_v_base + (s % hangul_n_count) / hangul_t_count;
+            if (s % hangul_t_count != 0) out += hangul_t_base + s % hangul_t_count;
+            return;
+        }
+        if ((lookup(cp).flags & nfd_no) == 0) {
+            out += cp;
+            return;
+        }
+        const auto* d = std::lower_bound(std::begin(decompositions), std::end(decompositions), cp,
+                                         [](const decomposition& e, char32_t c) { return e.cp < c; });
+        out.append(decomposition_pool + d->offset, d->length);
+    }
+
+
+    /// @brief The primary composite of `first` followed by `second`, or 0 when they do not compose
+    inline char32_t compose(char32_t first, char32_t second) noexcept
+    {
+        if (first - hangul_l_base < hangul_l_count && second - hangul_v_base < hangul_v_count) {
+            return hangul_s_base + ((first - hangul_l_base) * hangul_v_count + (second - hangul_v_base)) * hangul_t_count;
+        }
+        if (first - hangul_s_base < hangul_s_count && (first - hangul_s_base) % hangul_t_count == 0 &&
+            second - hangul_t_base - 1 < hangul_t_count - 1)
+        {
+            return first + (second - hangul_t_base);
+        }
+
+        const auto* c = std::lower_bound(std::begin(compositions), std::end(compositions), std::pair {first, second},
+                                         [](const composition& e, const std::pair<char32_t, char32_t>& k) {
+                                             return e.first < k.first || (e.first == k.first && e.second < k.second);
+                                         });
+        return (c != std::end(compositions) && c->first == first && c->second == second) ? c->composite : 0;
+    }
+
+
+    /// @brief Puts every run of non-starters in `cps` in canonical order (stable by combining class)
+    inline void reorder(std::u32string& cps) noexcept
+    {
+        for (std::size_t i = 1; i < cps.size(); i++) {
+            const auto cp  = cps[i];
+            const auto ccc = lookup(cp).ccc;
+            if (ccc == 0) continue;
+
+            std::size_t j = i;
+            for (; j > 0; j--) {
+                const auto prev = lookup(cps[j - 1]).ccc;
+                if (prev <= ccc) break;
+                cps[j] = cps[j - 1];
+            }
+            cps[j] = cp;
+        }
+    }
+
+
+    /// @brief Canonical composition of decomposed, canonically ordered `cps` in place
+    inline void recompose(std::u32string& cps) noexcept
+    {
+        constexpr auto none    = static_cast<std::size_t>(-1);
+        std::size_t    starter = none, w = 0;
+        std::uint8_t   last    = 0;
+
+        for (std::size_t i = 0; i < cps.size(); i++) {
+            const auto cp  = cps[i];
+            const auto ccc = lookup(cp).ccc;
+
+            // Not blocked from the starter: adjacent to it, or every character in between has a lower class
+            if (starter != none && (w == starter + 1 || (last != 0 && last < ccc))) {
+                if (const auto composite = compose(cps[starter], cp); composite != 0) {
+                    cps[starter] = composite;
+                    continue;
+                }
+            }
+            if (ccc == 0) starter = w;
+            last      = ccc;
+            cps[w++]  = cp;
+        }
+        cps.resize(w);
+    }
+
+
+    /*
+        `stable_run` returns the length of the leading run of units below `limit`. Below U+0300 (U+00C0 for
+        NFD) every code point has combining class 0 and passes the quick check; in UTF-8 that is every byte
+        below 0xCC (0xC3). Valid input is assumed.
+    */
+
+    template <typename U>
+    inline std::size_t stable_run_scalar(const U* s, std::size_t n, U limit) noexcept
+    {
+        std::size_t i = 0;
+        while (i < n && s[i] < limit) i++;
+        return i;
+    }
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+    template <typename U>
+    inline std::size_t stable_run_sse2(const U* s, std::size_t n, U limit) noexcept
+    {
+        constexpr std::size_t lanes = 16 / sizeof(U);
+        std::size_t           i     = 0;
+        for (; i + lanes <= n; i += lanes) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            __m128i       at_or_above;
+            if constexpr (sizeof(U) == 1) at_or_above = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(static_cast<char>(limit))), v);
+            else if constexpr (sizeof(U) == 2)
+                at_or_above = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_set1_epi16(static_cast<short>(limit)), v), _mm_setzero_si128());
+            else at_or_above = _mm_cmpgt_epi32(v, _mm_set1_epi32(static_cast<int>(limit) - 1));
+
+            const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(at_or_above));
+            if (mask != 0) return i + static_cast<std::size_t>(utf::lowest_bit(mask)) / sizeof(U);
+        }
+        return i + stable_run_scalar(s + i, n - i, limit);
+    }
+
+    template <typename U>
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t stable_run_avx2(const U* s, std::size_t n, U limit) noexcept
+    {
+        constexpr std::size_t lanes = 32 / sizeof(U);
+        std::size_t           i     = 0;
+        for (; i + lanes <= n; i += lanes) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            __m256i       at_or_above;
+            if constexpr (sizeof(U) == 1) at_or_above = _mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(static_cast<char>(limit))), v);
+            else if constexpr (sizeof(U) == 2)
+                at_or_above = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_set1_epi16(static_cast<short>(limit)), v), _mm256_setzero_si256());
+            else at_or_above = _mm256_cmpgt_epi32(v, _mm256_set1_epi32(static_cast<int>(limit) - 1));
+
+            const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(at_or_above));
+            if (mask != 0) return i + static_cast<std::size_t>(utf::lowest_bit(mask)) / sizeof(U);
+        }
+        return i + stable_run_sse2(s + i, n - i, limit);
+    }
+#endif
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+    template <typename U>
+    inline std::size_t stable_run_neon(const U* s, std::size_t n, U limit) noexcept
+    {
+        constexpr std::size_t lanes = 16 / sizeof(U);
+        std::size_t           i     = 0;
+        for (; i + lanes <= n; i += lanes) {
+            bool above;
+            if constexpr (sizeof(U) == 1) above = vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(s + i))) >= limit;
+            else if constexpr (sizeof(U) == 2) above = vmaxvq_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(s + i))) >= limit;
+            else above = vmaxvq_u32(vld1q_u32(reinterpret_cast<const uint32_t*>(s + i))) >= limit;
+            if (above) break;
+        }
+        return i + stable_run_scalar(s + i, n - i, limit);
+    }
+#endif
+
+
+    /// @brief The quick-check kernel for units of U, chosen once
+    template <typename U>
+    inline auto stable_run_kernel() noexcept -> std::size_t (*)(const U*, std::size_t, U) noexcept
+    {
+        static const auto k = []() noexcept -> std::size_t (*)(const U*, std::size_t, U) noexcept {
+            switch (utf::detected_simd_level()) {
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+                case utf::simd_level::avx2: return &stable_run_avx2<U>;
+                case utf::simd_level::sse2: return &stable_run_sse2<U>;
+#endif
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+                case utf::simd_level::neon: return &stable_run_neon<U>;
+#endif
+                default: return &stable_run_scalar<U>;
+            }
+        }();
+        return k;
+    }
+
+
+    enum class quick_check_status
+    {
+        yes,
+        no,
+        maybe
+    };
+
+    /// @brief Quick-check outcome; normalization only has to start at `start`, the last starter before the
+    /// first code point that failed (or may fail) the check
+    struct quick_check_result
+    {
+        quick_check_status status;
+        std::size_t        start;
+    };
+
+
+    /// @brief UAX #15 quick check of valid input `s` for `form`
+    template <typename S>
+    inline quick_check_result quick_check(const S* s, std::size_t n, normalization_form form) noexcept
+    {
+        using U = std::conditional_t<sizeof(S) == 1, std::uint8_t, std::conditional_t<sizeof(S) == 2, std::uint16_t, std::uint32_t>>;
+        constexpr bool utf8 = utf::encoding_of<S> == utf::encoding::utf8;
+
+        const auto* units    = reinterpret_cast<const U*>(s);
+        const auto  run      = stable_run_kernel<U>();
+        const auto  limit    = static_cast<U>(form == normalization_form::nfc ? (utf8 ? 0xCC : 0x300) : (utf8 ? 0xC3 : 0xC0));
+        const auto  no_flags = (form == normalization_form::nfc) ? nfc_no : nfd_no;
+
+        quick_check_result result {quick_check_status::yes, 0};
+        std::size_t        starter = 0;
+        std::uint8_t       last    = 0;
+        for (std::size_t i = 0; i < n;) {
+            if (const auto stable = run(units + i, n - i, limit); stable > 0) {
+                i += stable;
+                // Start of the last code point in the run; below the limit UTF-8 has at most one trailing byte
+                starter = i - 1;
+                if constexpr (utf8) starter -= (starter > 0 && (units[starter] & 0xC0) == 0x80);
+                last = 0;
+                if (i == n) break;
+            }
+
+            char32_t   cp {};
+            const auto length = utf::decode(s + i, n - i, cp);
+            const auto& p     = lookup(cp);
+            if ((p.ccc != 0 && last > p.ccc) || (p.flags & no_flags) != 0) {
+                return {quick_check_status::no, (result.status == quick_check_status::maybe) ? result.start : starter};
+            }
+            if (form == normalization_form::nfc && (p.flags & nfc_maybe) != 0 && result.status == quick_check_status::yes) {
+                result = {quick_check_status::maybe, starter};
+            }
+            if (p.ccc == 0) starter = i;
+            last = p.ccc;
+            i += static_cast<std::size_t>(length);
+        }
+        return result;
+    }
+} // namespace siddiqsoft::normalization
+
+
+/// @brief SiddiqSoft
+namespace siddiqsoft
+{
+    /// @brief Unicode normalization (NFC and NFD) of UTF-8, UTF-16, UTF-32 and wide strings.
+    /// Input that passes the vectorized quick check, which is most text, is returned as it is; only the tail
+    /// from the first code point that needs work is decomposed, reordered and recomposed.
+    struct NormalizationUtils
+    {
+        /// @brief True when `src` is already in `form`
+        /// @throws std::range_error when `src` is not well-formed in its encoding
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static auto is_normalized(std::type_identity_t<std::basic_string_view<S>> src, normalization_form form = normalization_form::nfc)
+                -> bool
+        {
+            const auto qc = check<S>(src, form);
+            if (qc.status != normalization::quick_check_status::maybe) return qc.status == normalization::quick_check_status::yes;
+
+            std::basic_string<S> tail;
+            normalize_tail<S>(src.substr(qc.start), tail, form);
+            return src.substr(qc.start) == tail;
+        }
+
+
+        /// @brief Returns `src` in `form`
+        /// @throws std::range_error when `src` is not well-formed in its encoding
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static auto normalize(std::type_identity_t<std::basic_string_view<S>> src, normalization_form form = normalization_form::nfc)
+                -> std::basic_string<S>
+        {
+            std::basic_string<S> out;
+            normalize_into<S>(src, out, form);
+            return out;
+        }
+
+
+        /// @brief Returns `src` itself when it is already in `form`; otherwise normalizes it into `storage`
+        /// (replacing its contents) and returns a view of `storage`
+        /// @throws std::range_error when `src` is not well-formed in its encoding
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static auto normalized(std::type_identity_t<std::basic_string_view<S>> src,
+                               std::basic_string<S>&                            storage,
+                               normalization_form                               form = normalization_form::nfc) -> std::basic_string_view<S>
+        {
+            const auto qc = check<S>(src, form);
+            if (qc.status == normalization::quick_check_status::yes) return src;
+
+            storage.assign(src.substr(0, qc.start));
+            normalize_tail<S>(src.substr(qc.start), storage, form);
+            return storage;
+        }
+
+
+        /// @brief Appends `src` in `form` to `dst`
+        /// @throws std::range_error when `src` is not well-formed in its encoding
+        template <typename S = char>
+            requires utf::unicode_char<S>
+        static void normalize_into(std::type_identity_t<std::basic_string_view<S>> src,
+                                   std::basic_string<S>&                            dst,
+                                   normalization_form                               form = normalization_form::nfc)
+        {
+            const auto qc = check<S>(src, form);
+            if (qc.status == normalization::quick_check_status::yes) {
+                dst.append(src);
+                return;
+            }
+            dst.append(src.substr(0, qc.start));
+            normalize_tail<S>(src.substr(qc.start), dst, form);
+        }
+
+    private:
+        template <typename S>
+        static auto check(std::basic_string_view<S> src, normalization_form form) -> normalization::quick_check_result
+        {
+            if (utf::validate(src.data(), src.size()).status != utf::transcode_status::ok) {
+                throw std::range_error("NormalizationUtils - invalid or incomplete sequence");
+            }
+            return normalization::quick_check(src.data(), src.size(), form);
+        }
+
+
+        /// @brief Decomposes, reorders and (for NFC) recomposes valid `src` and appends it to `dst`
+        template <typename S>
+        static void normalize_tail(std::basic_string_view<S> src, std::basic_string<S>& dst, normalization_form form)
+        {
+            std::u32string cps;
+            cps.reserve(src.size() + src.size() / 2);
+            for (size_t i = 0; i < src.size();) {
+                char32_t cp {};
+                i += static_cast<size_t>(utf::decode(src.data() + i, src.size() - i, cp));
+                normalization::decompose(cp, cps);
+            }
+            normalization::reorder(cps);
+            if (form == normalization_form::nfc) normalization::recompose(cps);
+
+            size_t o = dst.size();
+            dst.resize(o + cps.size() * (4 / sizeof(S)));
+            for (const auto cp : cps) o += static_cast<size_t>(utf::encode(cp, dst.data() + o));
+            dst.resize(o);
+        }
+    };
+} // namespace siddiqsoft
+
+#endif
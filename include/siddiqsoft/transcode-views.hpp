@@ -0,0 +1,229 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifndef TRANSCODE_VIEWS_HPP
+#define TRANSCODE_VIEWS_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include "conversion-utils.hpp"
+
+// std::ranges::range_adaptor_closure (C++23) lets `views::transcode<S, D>` be composed with other adaptors
+// before it is applied to a range. Without it the adaptor only works with a range on its left.
+#if defined(__cpp_lib_ranges) && (__cpp_lib_ranges >= 202202L)
+#  define SIDDIQSOFT_STRINGHELPERS_RANGE_ADAPTOR_CLOSURE 1
+#endif
+
+
+/// @brief SiddiqSoft
+namespace siddiqsoft
+{
+    /// @brief A view of the contiguous range V (code units of S) as code units of D, decoded one code point
+    /// at a time as it is iterated; nothing is allocated. Malformed input reads as U+FFFD REPLACEMENT
+    /// CHARACTER, one per maximal invalid subpart (as error_policy::replace).
+    template <std::ranges::view V, typename D>
+        requires std::ranges::contiguous_range<const V> && std::ranges::sized_range<const V> &&
+                 ConvertiblePair<std::ranges::range_value_t<V>, D>
+    class transcode_view : public std::ranges::view_interface<transcode_view<V, D>>
+    {
+        using S = std::ranges::range_value_t<V>;
+
+    public:
+        class iterator
+        {
+        public:
+            using iterator_concept = std::forward_iterator_tag;
+            using value_type       = D;
+            using difference_type  = std::ptrdiff_t;
+
+            iterator() = default;
+
+            constexpr iterator(const S* pos, const S* end) noexcept
+                : cur(pos)
+                , last(end)
+            {
+                decode();
+            }
+
+            constexpr auto operator*() const noexcept -> D { return units[index]; }
+
+            constexpr auto operator++() noexcept -> iterator&
+            {
+                if (++index == count) {
+                    cur += consumed;
+                    decode();
+                }
+                return *this;
+            }
+
+            constexpr auto operator++(int) noexcept -> iterator
+            {
+                auto copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            constexpr bool operator==(const iterator& other) const noexcept { return cur == other.cur && index == other.index; }
+
+            /// @brief The source code unit that starts the code point being read
+            constexpr auto base() const noexcept -> const S* { return cur; }
+
+        private:
+            /// @brief Decodes the code point at `cur` into `units`
+            constexpr void decode() noexcept
+            {
+                index = 0;
+                if (cur == last) {
+                    count = consumed = 0;
+                    return;
+                }
+
+                const auto n  = static_cast<std::size_t>(last - cur);
+                char32_t   cp {};
+                int        used = utf::decode(cur, n, cp);
+                if (used <= 0) {
+                    cp   = 0xFFFD;
+                    used = static_cast<int>(utf::invalid_length(cur, n));
+                }
+                consumed = static_cast<std::uint8_t>(used);
+                count    = static_cast<std::uint8_t>(utf::encode(cp, units));
+            }
+
+            const S*     cur {nullptr};
+            const S*     last {nullptr};
+            D            units[4] {};
+            std::uint8_t count {0};
+            std::uint8_t index {0};
+            std::uint8_t consumed {0};
+        };
+
+        transcode_view()
+            requires std::default_initializable<V>
+        = default;
+
+        constexpr explicit transcode_view(V base)
+            : src(std::move(base))
+        {
+        }
+
+        constexpr auto base() const& -> V
+            requires std::copy_constructible<V>
+        {
+            return src;
+        }
+
+        constexpr auto base() && -> V { return std::move(src); }
+
+        constexpr auto begin() const -> iterator
+        {
+            const S* data = std::ranges::data(src);
+            return {data, data + std::ranges::size(src)};
+        }
+
+        constexpr auto end() const -> iterator
+        {
+            const S* data = std::ranges::data(src) + std::ranges::size(src);
+            return {data, data};
+        }
+
+    private:
+        V src {};
+    };
+
+
+    namespace views
+    {
+        /// @brief Range adaptor closure for `transcode<S, D>`
+        template <typename S, typename D>
+            requires ConvertiblePair<S, D>
+        struct transcode_fn
+#if defined(SIDDIQSOFT_STRINGHELPERS_RANGE_ADAPTOR_CLOSURE)
+            : std::ranges::range_adaptor_closure<transcode_fn<S, D>>
+#endif
+        {
+            template <std::ranges::viewable_range R>
+                requires std::same_as<std::ranges::range_value_t<R>, S>
+            constexpr auto operator()(R&& r) const
+            {
+                return transcode_view<std::views::all_t<R>, D> {std::views::all(std::forward<R>(r))};
+            }
+
+#if !defined(SIDDIQSOFT_STRINGHELPERS_RANGE_ADAPTOR_CLOSURE)
+            // C++20 has no portable closure base: `src | transcode<S, D> | std::views::take(n)` works, but
+            // `transcode<S, D> | std::views::take(n)` cannot be composed ahead of the range.
+            template <std::ranges::viewable_range R>
+                requires std::same_as<std::ranges::range_value_t<R>, S>
+            friend constexpr auto operator|(R&& r, const transcode_fn& self)
+            {
+                return self(std::forward<R>(r));
+            }
+#endif
+        };
+
+        /// @brief Lazily converts a contiguous range of S to D, over the same pairs as ConversionUtils::convert_to.
+        /// @code
+        ///     auto wide = std::string_view {"x-ms-version"} | siddiqsoft::views::transcode<char, wchar_t>;
+        ///     auto dash = std::ranges::find(wide, L'-');
+        /// @endcode
+        template <typename S, typename D>
+            requires ConvertiblePair<S, D>
+        inline constexpr transcode_fn<S, D> transcode {};
+
+        inline constexpr auto utf8_to_utf16  = transcode<char, char16_t>;
+        inline constexpr auto utf8_to_utf32  = transcode<char, char32_t>;
+        inline constexpr auto utf16_to_utf8  = transcode<char16_t, char>;
+        inline constexpr auto utf16_to_utf32 = transcode<char16_t, char32_t>;
+        inline constexpr auto utf32_to_utf8  = transcode<char32_t, char>;
+        inline constexpr auto utf32_to_utf16 = transcode<char32_t, char16_t>;
+    } // namespace views
+} // namespace siddiqsoft
+
+
+namespace std::ranges
+{
+    /// @brief The iterators point into the underlying range, so the view borrows whenever its base does
+    template <typename V, typename D>
+    inline constexpr bool enable_borrowed_range<siddiqsoft::transcode_view<V, D>> = enable_borrowed_range<V>;
+} // namespace std::ranges
+
+#endif
@@ -0,0 +1,1243 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifndef UTF_TRANSCODER_HPP
+#define UTF_TRANSCODER_HPP
+
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "conversion-stats.hpp"
+
+// Define SIDDIQSOFT_STRINGHELPERS_NO_SIMD to force the portable scalar kernels.
+#if !defined(SIDDIQSOFT_STRINGHELPERS_NO_SIMD)
+#  if defined(__x86_64__) || defined(_M_X64) || \
+          (defined(__i386__) && defined(__SSE2__)) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#    define SIDDIQSOFT_STRINGHELPERS_X86 1
+#    include <immintrin.h>
+#    if defined(_MSC_VER) && !defined(__clang__)
+#      include <intrin.h>
+#      define SIDDIQSOFT_TARGET_AVX2
+#    else
+#      define SIDDIQSOFT_TARGET_AVX2 __attribute__((target("avx2")))
+#    endif
+#  elif defined(__aarch64__) || defined(_M_ARM64)
+#    define SIDDIQSOFT_STRINGHELPERS_NEON 1
+#    include <arm_neon.h>
+#  endif
+#endif
+
+// Keeps a helper out of line where inlining it would only add code (or false -Warray-bounds reports)
+#if defined(_MSC_VER) && !defined(__clang__)
+#  define SIDDIQSOFT_NOINLINE __declspec(noinline)
+#else
+#  define SIDDIQSOFT_NOINLINE __attribute__((noinline))
+#endif
+
+/// @brief SiddiqSoft
+namespace siddiqsoft::utf
+{
+    /// @brief Instruction set selected at runtime for the ASCII fast paths
+    enum class simd_level
+    {
+        scalar,
+        sse2,
+        avx2,
+        neon
+    };
+
+
+    /// @brief Outcome of a transcoding kernel
+    enum class transcode_status
+    {
+        ok,
+        invalid_sequence,    // malformed, overlong, surrogate or out-of-range code point
+        incomplete_sequence, // the input ends in the middle of a multi-byte sequence
+        output_too_small     // the destination filled up before the input was consumed
+    };
+
+
+    /// @brief Result of a transcoding kernel; `written` and `consumed` are in code units.
+    /// On failure `consumed` is the offset of the offending (or first unconverted) source unit.
+    struct transcode_result
+    {
+        std::size_t      written {0};
+        std::size_t      consumed {0};
+        transcode_status status {transcode_status::ok};
+    };
+
+
+    /// @brief Probes the processor once and returns the best supported fast path
+    inline simd_level detected_simd_level() noexcept
+    {
+        static const simd_level level = []() noexcept {
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+#  if defined(_MSC_VER) && !defined(__clang__)
+            int regs[4] {};
+            __cpuid(regs, 0);
+            if (regs[0] >= 7) {
+                __cpuid(regs, 1);
+                const bool osxsave = (regs[2] & (1 << 27)) != 0;
+                const bool avx     = (regs[2] & (1 << 28)) != 0;
+                __cpuidex(regs, 7, 0);
+                const bool avx2 = (regs[1] & (1 << 5)) != 0;
+                if (osxsave && avx && avx2 && ((_xgetbv(0) & 0x6) == 0x6)) return simd_level::avx2;
+            }
+            return simd_level::sse2;
+#  else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? simd_level::avx2 : simd_level::sse2;
+#  endif
+#elif defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+            return simd_level::neon;
+#else
+            return simd_level::scalar;
+#endif
+        }();
+        return level;
+    }
+
+
+    /// @brief Decodes one UTF-8 sequence starting at `s` per RFC 3629 / Unicode Table 3-7.
+    /// @param s Start of the sequence; must be a lead byte
+    /// @param n Bytes available (at least 1)
+    /// @param cp Receives the code point
+    /// @return Length of the sequence (1..4), 0 when invalid or -1 when the input ends mid-sequence
+    template <typename C>
+        requires(sizeof(C) == 1)
+    constexpr int decode_utf8(const C* s, std::size_t n, char32_t& cp) noexcept
+    {
+        const auto b0 = static_cast<unsigned char>(s[0]);
+        if (b0 < 0x80) {
+            cp = b0;
+            return 1;
+        }
+
+        int           len {0};
+        unsigned char lo {0x80}, hi {0xBF};
+        if (b0 >= 0xC2 && b0 <= 0xDF) {
+            len = 2;
+            cp  = b0 & 0x1F;
+        }
+        else if (b0 >= 0xE0 && b0 <= 0xEF) {
+            len = 3;
+            cp  = b0 & 0x0F;
+            if (b0 == 0xE0) lo = 0xA0; // overlong
+            if (b0 == 0xED) hi = 0x9F; // surrogates
+        }
+        else if (b0 >= 0xF0 && b0 <= 0xF4) {
+            len = 4;
+            cp  = b0 & 0x07;
+            if (b0 == 0xF0) lo = 0x90; // overlong
+            if (b0 == 0xF4) hi = 0x8F; // beyond U+10FFFF
+        }
+        else {
+            return 0;
+        }
+
+        for (int i = 1; i < len; i++) {
+            if (static_cast<std::size_t>(i) >= n) return -1;
+            const auto b = static_cast<unsigned char>(s[i]);
+            if (b < lo || b > hi) return 0;
+            lo = 0x80;
+            hi = 0xBF;
+            cp = (cp << 6) | (b & 0x3F);
+        }
+        return len;
+    }
+
+
+    /// @brief Encodes a scalar value as UTF-8 into `d` (room for 4 bytes required)
+    /// @return Bytes written or 0 when `cp` is a surrogate or beyond U+10FFFF
+    template <typename C>
+        requires(sizeof(C) == 1)
+    constexpr int encode_utf8(char32_t cp, C* d) noexcept
+    {
+        if (cp < 0x80) {
+            d[0] = static_cast<C>(cp);
+            return 1;
+        }
+        if (cp < 0x800) {
+            d[0] = static_cast<C>(0xC0 | (cp >> 6));
+            d[1] = static_cast<C>(0x80 | (cp & 0x3F));
+            return 2;
+        }
+        if (cp < 0x10000) {
+            if (cp >= 0xD800 && cp <= 0xDFFF) return 0;
+            d[0] = static_cast<C>(0xE0 | (cp >> 12));
+            d[1] = static_cast<C>(0x80 | ((cp >> 6) & 0x3F));
+            d[2] = static_cast<C>(0x80 | (cp & 0x3F));
+            return 3;
+        }
+        if (cp <= 0x10FFFF) {
+            d[0] = static_cast<C>(0xF0 | (cp >> 18));
+            d[1] = static_cast<C>(0x80 | ((cp >> 12) & 0x3F));
+            d[2] = static_cast<C>(0x80 | ((cp >> 6) & 0x3F));
+            d[3] = static_cast<C>(0x80 | (cp & 0x3F));
+            return 4;
+        }
+        return 0;
+    }
+
+
+    /// @brief Length of the UTF-8 sequence introduced by the lead byte `b` (1 for ASCII or malformed bytes)
+    inline std::size_t utf8_sequence_length(char b) noexcept
+    {
+        const auto u = static_cast<unsigned char>(b);
+        return (u >= 0xF0 && u <= 0xF4) ? 4 : (u >= 0xE0 && u <= 0xEF) ? 3 : (u >= 0xC2 && u <= 0xDF) ? 2 : 1;
+    }
+
+
+    /// @brief Length of the longest prefix of `s` that does not end inside a UTF-8 multi-byte sequence.
+    /// Only a trailing lead byte (plus its continuation bytes) that still expects more input is excluded;
+    /// malformed bytes are left in the prefix for the decoder to report.
+    inline std::size_t utf8_complete_prefix(const char* s, std::size_t n) noexcept
+    {
+        for (std::size_t k = 1; k <= 3 && k <= n; k++) {
+            const auto b = static_cast<unsigned char>(s[n - k]);
+            if ((b & 0xC0) == 0x80) continue;
+
+            return (utf8_sequence_length(s[n - k]) > k) ? n - k : n;
+        }
+        return n;
+    }
+
+
+    /*
+        ASCII run kernels
+
+        Each kernel converts the longest leading run of 7-bit ASCII code units and returns
+        its length; the caller resumes with the scalar decoder at the first non-ASCII unit.
+        U is a 16-bit (char16_t, wchar_t on Windows) or 32-bit (char32_t, wchar_t elsewhere) code unit.
+    */
+
+    template <typename U>
+    inline std::size_t widen_ascii_scalar(const char* s, std::size_t n, U* d) noexcept
+    {
+        std::size_t i = 0;
+        for (; i < n && static_cast<unsigned char>(s[i]) < 0x80; i++) d[i] = static_cast<U>(s[i]);
+        return i;
+    }
+
+    template <typename U>
+    inline std::size_t narrow_ascii_scalar(const U* s, std::size_t n, char* d) noexcept
+    {
+        std::size_t i = 0;
+        for (; i < n && static_cast<std::uint32_t>(s[i]) < 0x80; i++) d[i] = static_cast<char>(s[i]);
+        return i;
+    }
+
+    /// @brief Index of the lowest set bit; `mask` must be non-zero
+    inline int lowest_bit(std::uint32_t mask) noexcept
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long idx {};
+        _BitScanForward(&idx, mask);
+        return static_cast<int>(idx);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+    template <typename U>
+    inline std::size_t widen_ascii_sse2(const char* s, std::size_t n, U* d) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        std::size_t   i    = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            const int     mask = _mm_movemask_epi8(v);
+            if (mask != 0) return i + widen_ascii_scalar(s + i, static_cast<std::size_t>(lowest_bit(mask)), d + i);
+
+            const __m128i lo  = _mm_unpacklo_epi8(v, zero);
+            const __m128i hi  = _mm_unpackhi_epi8(v, zero);
+            auto*         out = reinterpret_cast<__m128i*>(d + i);
+            if constexpr (sizeof(U) == 2) {
+                _mm_storeu_si128(out + 0, lo);
+                _mm_storeu_si128(out + 1, hi);
+            }
+            else {
+                _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+            }
+        }
+        return i + widen_ascii_scalar(s + i, n - i, d + i);
+    }
+
+    template <typename U>
+    inline std::size_t narrow_ascii_sse2(const U* s, std::size_t n, char* d) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        std::size_t   i    = 0;
+        for (; i + 16 <= n; i += 16) {
+            const auto* in = reinterpret_cast<const __m128i*>(s + i);
+            __m128i     bytes {};
+            if constexpr (sizeof(U) == 2) {
+                const __m128i v0  = _mm_loadu_si128(in + 0);
+                const __m128i v1  = _mm_loadu_si128(in + 1);
+                const __m128i any = _mm_and_si128(_mm_or_si128(v0, v1), _mm_set1_epi16(static_cast<short>(0xFF80)));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(any, zero)) != 0xFFFF) break;
+                bytes = _mm_packus_epi16(v0, v1);
+            }
+            else {
+                const __m128i v0  = _mm_loadu_si128(in + 0);
+                const __m128i v1  = _mm_loadu_si128(in + 1);
+                const __m128i v2  = _mm_loadu_si128(in + 2);
+                const __m128i v3  = _mm_loadu_si128(in + 3);
+                const __m128i any = _mm_and_si128(_mm_or_si128(_mm_or_si128(v0, v1), _mm_or_si128(v2, v3)), _mm_set1_epi32(~0x7F));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(any, zero)) != 0xFFFF) break;
+                // Values are below 0x80 so the saturating packs are exact.
+                bytes = _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), bytes);
+        }
+        return i + narrow_ascii_scalar(s + i, n - i, d + i);
+    }
+
+    template <typename U>
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t widen_ascii_avx2(const char* s, std::size_t n, U* d) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            const auto    mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(v));
+            if (mask != 0) return i + widen_ascii_scalar(s + i, static_cast<std::size_t>(lowest_bit(mask)), d + i);
+
+            auto* out = reinterpret_cast<__m256i*>(d + i);
+            if constexpr (sizeof(U) == 2) {
+                _mm256_storeu_si256(out + 0, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+                _mm256_storeu_si256(out + 1, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+            }
+            else {
+                for (int k = 0; k < 4; k++) {
+                    const __m128i eight = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + i + (8 * k)));
+                    _mm256_storeu_si256(out + k, _mm256_cvtepu8_epi32(eight));
+                }
+            }
+        }
+        return i + widen_ascii_scalar(s + i, n - i, d + i);
+    }
+
+    template <typename U>
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t narrow_ascii_avx2(const U* s, std::size_t n, char* d) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const auto* in = reinterpret_cast<const __m256i*>(s + i);
+            __m256i     bytes {};
+            // The packs interleave 128-bit lanes; the permutes restore the source order.
+            if constexpr (sizeof(U) == 2) {
+                const __m256i v0 = _mm256_loadu_si256(in + 0);
+                const __m256i v1 = _mm256_loadu_si256(in + 1);
+                if (!_mm256_testz_si256(_mm256_or_si256(v0, v1), _mm256_set1_epi16(static_cast<short>(0xFF80)))) break;
+                bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(v0, v1), 0xD8);
+            }
+            else {
+                const __m256i v0  = _mm256_loadu_si256(in + 0);
+                const __m256i v1  = _mm256_loadu_si256(in + 1);
+                const __m256i v2  = _mm256_loadu_si256(in + 2);
+                const __m256i v3  = _mm256_loadu_si256(in + 3);
+                const __m256i any = _mm256_or_si256(_mm256_or_si256(v0, v1), _mm256_or_si256(v2, v3));
+                if (!_mm256_testz_si256(any, _mm256_set1_epi32(~0x7F))) break;
+                const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(v0, v1), _mm256_packs_epi32(v2, v3));
+                bytes = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), bytes);
+        }
+        return i + narrow_ascii_sse2(s + i, n - i, d + i);
+    }
+#endif
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+    template <typename U>
+    inline std::size_t widen_ascii_neon(const char* s, std::size_t n, U* d) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const uint8x16_t v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(s + i));
+            if (vmaxvq_u8(v) >= 0x80) break;
+
+            const uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+            const uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+            if constexpr (sizeof(U) == 2) {
+                auto* out = reinterpret_cast<std::uint16_t*>(d + i);
+                vst1q_u16(out + 0, lo);
+                vst1q_u16(out + 8, hi);
+            }
+            else {
+                auto* out = reinterpret_cast<std::uint32_t*>(d + i);
+                vst1q_u32(out + 0, vmovl_u16(vget_low_u16(lo)));
+                vst1q_u32(out + 4, vmovl_u16(vget_high_u16(lo)));
+                vst1q_u32(out + 8, vmovl_u16(vget_low_u16(hi)));
+                vst1q_u32(out + 12, vmovl_u16(vget_high_u16(hi)));
+            }
+        }
+        return i + widen_ascii_scalar(s + i, n - i, d + i);
+    }
+
+    template <typename U>
+    inline std::size_t narrow_ascii_neon(const U* s, std::size_t n, char* d) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            uint16x8_t w {};
+            if constexpr (sizeof(U) == 2) {
+                w = vld1q_u16(reinterpret_cast<const std::uint16_t*>(s + i));
+                if (vmaxvq_u16(w) >= 0x80) break;
+            }
+            else {
+                const auto*      in = reinterpret_cast<const std::uint32_t*>(s + i);
+                const uint32x4_t v0 = vld1q_u32(in);
+                const uint32x4_t v1 = vld1q_u32(in + 4);
+                if (vmaxvq_u32(vorrq_u32(v0, v1)) >= 0x80) break;
+                w = vcombine_u16(vmovn_u32(v0), vmovn_u32(v1));
+            }
+            vst1_u8(reinterpret_cast<std::uint8_t*>(d + i), vmovn_u16(w));
+        }
+        return i + narrow_ascii_scalar(s + i, n - i, d + i);
+    }
+#endif
+
+
+    /// @brief ASCII run kernels for the code unit U chosen once for the running processor
+    template <typename U>
+        requires(sizeof(U) == 2 || sizeof(U) == 4)
+    struct ascii_kernels
+    {
+        std::size_t (*widen)(const char*, std::size_t, U*) noexcept;
+        std::size_t (*narrow)(const U*, std::size_t, char*) noexcept;
+
+        static const ascii_kernels& get() noexcept
+        {
+            static const ascii_kernels k = []() noexcept -> ascii_kernels {
+                switch (detected_simd_level()) {
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+                    case simd_level::avx2: return {&widen_ascii_avx2<U>, &narrow_ascii_avx2<U>};
+                    case simd_level::sse2: return {&widen_ascii_sse2<U>, &narrow_ascii_sse2<U>};
+#endif
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+                    case simd_level::neon: return {&widen_ascii_neon<U>, &narrow_ascii_neon<U>};
+#endif
+                    default: return {&widen_ascii_scalar<U>, &narrow_ascii_scalar<U>};
+                }
+            }();
+            return k;
+        }
+    };
+
+
+    /*
+        Length pre-passes
+
+        Eight bytes are examined at a time as one 64-bit word. For UTF-8 a byte's bit 6 shifted into
+        bit 7 (`w << 1`) tells continuation bytes (10xxxxxx) from lead bytes without leaving the word;
+        for 16- and 32-bit input a word of ASCII units adds nothing beyond one byte per unit and is skipped.
+    */
+
+    inline constexpr std::uint64_t high_bits = 0x8080808080808080ull;
+
+    /// @brief True when the eight bytes at `p` hold only ASCII code units of U
+    template <typename U>
+    inline bool ascii_word(const U* p) noexcept
+    {
+        constexpr std::uint64_t mask = sizeof(U) == 1   ? high_bits
+                                       : sizeof(U) == 2 ? 0xFF80FF80FF80FF80ull
+                                                        : 0xFFFFFF80FFFFFF80ull;
+        std::uint64_t w;
+        std::memcpy(&w, p, sizeof(w));
+        return (w & mask) == 0;
+    }
+
+
+    /// @brief Number of 32-bit code units needed for the UTF-8 input (assumes the input is valid)
+    inline std::size_t utf32_length_from_utf8(const char* src, std::size_t n) noexcept
+    {
+        // Every byte except a continuation byte (10xxxxxx) starts a code point.
+        std::size_t len {0}, i {0};
+        for (; i + 8 <= n; i += 8) {
+            std::uint64_t w;
+            std::memcpy(&w, src + i, sizeof(w));
+            len += 8 - static_cast<std::size_t>(std::popcount(w & ~(w << 1) & high_bits));
+        }
+        for (; i < n; i++) len += (static_cast<signed char>(src[i]) > -65);
+        return len;
+    }
+
+
+    /// @brief Number of 16-bit code units needed for the UTF-8 input (assumes the input is valid)
+    inline std::size_t utf16_length_from_utf8(const char* src, std::size_t n) noexcept
+    {
+        // Four-byte sequences (lead byte 11110xxx) become surrogate pairs.
+        std::size_t len {0}, i {0};
+        for (; i + 8 <= n; i += 8) {
+            std::uint64_t w;
+            std::memcpy(&w, src + i, sizeof(w));
+            len += 8 - static_cast<std::size_t>(std::popcount(w & ~(w << 1) & high_bits)) +
+                   static_cast<std::size_t>(std::popcount(w & (w << 1) & (w << 2) & (w << 3) & high_bits));
+        }
+        for (; i < n; i++) {
+            const auto b = static_cast<unsigned char>(src[i]);
+            len += (b < 0x80 || b >= 0xC0) + (b >= 0xF0);
+        }
+        return len;
+    }
+
+
+    /// @brief Number of UTF-8 bytes needed for the 32-bit code units (invalid units are not detected here)
+    template <typename U>
+        requires(sizeof(U) == 4)
+    inline std::size_t utf8_length_from_utf32(const U* src, std::size_t n) noexcept
+    {
+        std::size_t len {n}, i {0};
+        while (i < n) {
+            if (i + 2 <= n && ascii_word(src + i)) {
+                i += 2;
+                continue;
+            }
+            const std::size_t end = (i + 2 < n) ? i + 2 : n;
+            for (; i < end; i++) {
+                const auto c = static_cast<std::uint32_t>(src[i]);
+                len += (c >= 0x80) + (c >= 0x800) + (c >= 0x10000);
+            }
+        }
+        return len;
+    }
+
+
+    /// @brief Number of UTF-8 bytes needed for the 16-bit code units; each half of a surrogate pair counts two bytes
+    template <typename U>
+        requires(sizeof(U) == 2)
+    inline std::size_t utf8_length_from_utf16(const U* src, std::size_t n) noexcept
+    {
+        std::size_t len {n}, i {0};
+        while (i < n) {
+            if (i + 4 <= n && ascii_word(src + i)) {
+                i += 4;
+                continue;
+            }
+            const std::size_t end = (i + 4 < n) ? i + 4 : n;
+            for (; i < end; i++) {
+                const auto c = static_cast<std::uint32_t>(src[i]);
+                len += (c >= 0x80) + ((c >= 0x800) && (c < 0xD800 || c > 0xDFFF));
+            }
+        }
+        return len;
+    }
+    /// @brief Number of 32-bit code units needed for the 16-bit code units (assumes the input is valid)
+    template <typename U>
+        requires(sizeof(U) == 2)
+    inline std::size_t utf32_length_from_utf16(const U* src, std::size_t n) noexcept
+    {
+        std::size_t len {n};
+        for (std::size_t i = 0; i < n; i++) {
+            const auto c = static_cast<std::uint32_t>(src[i]);
+            len -= (c >= 0xDC00 && c <= 0xDFFF);
+        }
+        return len;
+    }
+
+
+    /// @brief Number of 16-bit code units needed for the 32-bit code units
+    template <typename U>
+        requires(sizeof(U) == 4)
+    inline std::size_t utf16_length_from_utf32(const U* src, std::size_t n) noexcept
+    {
+        std::size_t len {n};
+        for (std::size_t i = 0; i < n; i++) len += (static_cast<std::uint32_t>(src[i]) >= 0x10000);
+        return len;
+    }
+
+
+    /// @brief Transcodes UTF-8 into 16-bit (UTF-16) or 32-bit (UTF-32) code units
+    /// @param cap Room in `dst`; `n` (or `utf16_length_from_utf8`/`utf32_length_from_utf8`) is always sufficient
+    template <typename U>
+        requires(sizeof(U) == 2 || sizeof(U) == 4)
+    inline transcode_result utf8_to_utf16_32(const char* src, std::size_t n, U* dst, std::size_t cap) noexcept
+    {
+        const auto& k = ascii_kernels<U>::get();
+        std::size_t i {0}, o {0};
+
+        while (i < n) {
+            const std::size_t run = k.widen(src + i, (n - i) < (cap - o) ? (n - i) : (cap - o), dst + o);
+            stats::on_ascii(run);
+            i += run;
+            o += run;
+
+            while (i < n && static_cast<unsigned char>(src[i]) >= 0x80) {
+                char32_t  cp {};
+                const int len = decode_utf8(src + i, n - i, cp);
+                if (len <= 0) {
+                    return {o, i, len < 0 ? transcode_status::incomplete_sequence : transcode_status::invalid_sequence};
+                }
+                if constexpr (sizeof(U) == 2) {
+                    if (cp >= 0x10000) {
+                        if (cap - o < 2) return {o, i, transcode_status::output_too_small};
+                        dst[o++] = static_cast<U>(0xD800 + ((cp - 0x10000) >> 10));
+                        dst[o++] = static_cast<U>(0xDC00 + ((cp - 0x10000) & 0x3FF));
+                        i += static_cast<std::size_t>(len);
+                        continue;
+                    }
+                }
+                if (o == cap) return {o, i, transcode_status::output_too_small};
+                dst[o++] = static_cast<U>(cp);
+                i += static_cast<std::size_t>(len);
+            }
+            if (o == cap && i < n) return {o, i, transcode_status::output_too_small};
+        }
+        return {o, i, transcode_status::ok};
+    }
+
+
+    /// @brief Transcodes UTF-8 into 32-bit code units
+    template <typename U>
+        requires(sizeof(U) == 4)
+    inline transcode_result utf8_to_utf32(const char* src, std::size_t n, U* dst, std::size_t cap) noexcept
+    {
+        return utf8_to_utf16_32(src, n, dst, cap);
+    }
+
+
+    /// @brief Transcodes UTF-8 into 16-bit code units
+    template <typename U>
+        requires(sizeof(U) == 2)
+    inline transcode_result utf8_to_utf16(const char* src, std::size_t n, U* dst, std::size_t cap) noexcept
+    {
+        return utf8_to_utf16_32(src, n, dst, cap);
+    }
+
+
+    /// @brief Decodes the code point at `s[i]` from 16-bit units
+    /// @return Units used (1 or 2), 0 for an unpaired surrogate or -1 when the input ends after a high surrogate
+    template <typename U>
+        requires(sizeof(U) == 2)
+    constexpr int decode_utf16(const U* s, std::size_t n, char32_t& cp) noexcept
+    {
+        const auto c = static_cast<std::uint32_t>(static_cast<std::uint16_t>(s[0]));
+        if (c < 0xD800 || c > 0xDFFF) {
+            cp = c;
+            return 1;
+        }
+        if (c > 0xDBFF) return 0;
+        if (n < 2) return -1;
+
+        const auto c2 = static_cast<std::uint32_t>(static_cast<std::uint16_t>(s[1]));
+        if (c2 < 0xDC00 || c2 > 0xDFFF) return 0;
+        cp = 0x10000 + ((c - 0xD800) << 10) + (c2 - 0xDC00);
+        return 2;
+    }
+
+
+    /// @brief Transcodes 16-bit (UTF-16) or 32-bit (UTF-32) code units into UTF-8
+    /// @param cap Room in `dst`; `utf8_length_from_utf16`/`utf8_length_from_utf32` is always sufficient
+    template <typename U>
+        requires(sizeof(U) == 2 || sizeof(U) == 4)
+    inline transcode_result utf16_32_to_utf8(const U* src, std::size_t n, char* dst, std::size_t cap) noexcept
+    {
+        const auto& k = ascii_kernels<U>::get();
+        std::size_t i {0}, o {0};
+
+        while (i < n) {
+            const std::size_t run = k.narrow(src + i, (n - i) < (cap - o) ? (n - i) : (cap - o), dst + o);
+            stats::on_ascii(run * sizeof(U));
+            i += run;
+            o += run;
+
+            while (i < n && static_cast<std::uint32_t>(src[i]) >= 0x80) {
+                char32_t c {};
+                int      units {1};
+                if constexpr (sizeof(U) == 2) {
+                    units = decode_utf16(src + i, n - i, c);
+                    if (units <= 0) {
+                        return {o, i, units < 0 ? transcode_status::incomplete_sequence : transcode_status::invalid_sequence};
+                    }
+                }
+                else {
+                    c = static_cast<char32_t>(src[i]);
+                    if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) return {o, i, transcode_status::invalid_sequence};
+                }
+                const std::size_t need = 2 + (c >= 0x800) + (c >= 0x10000);
+                if (cap - o < need) return {o, i, transcode_status::output_too_small};
+                o += static_cast<std::size_t>(encode_utf8(c, dst + o));
+                i += static_cast<std::size_t>(units);
+            }
+            if (o == cap && i < n) return {o, i, transcode_status::output_too_small};
+        }
+        return {o, i, transcode_status::ok};
+    }
+
+
+    /// @brief Transcodes 32-bit code units into UTF-8
+    template <typename U>
+        requires(sizeof(U) == 4)
+    inline transcode_result utf32_to_utf8(const U* src, std::size_t n, char* dst, std::size_t cap) noexcept
+    {
+        return utf16_32_to_utf8(src, n, dst, cap);
+    }
+
+
+    /// @brief Transcodes 16-bit code units into UTF-8
+    template <typename U>
+        requires(sizeof(U) == 2)
+    inline transcode_result utf16_to_utf8(const U* src, std::size_t n, char* dst, std::size_t cap) noexcept
+    {
+        return utf16_32_to_utf8(src, n, dst, cap);
+    }
+
+
+    /// @brief Transcodes 16-bit code units into 32-bit code units
+    /// @param cap Room in `dst`; `n` is always sufficient
+    template <typename S, typename D>
+        requires(sizeof(S) == 2 && sizeof(D) == 4)
+    inline transcode_result utf16_to_utf32(const S* src, std::size_t n, D* dst, std::size_t cap) noexcept
+    {
+        std::size_t i {0}, o {0};
+        while (i < n) {
+            char32_t  cp {};
+            const int units = decode_utf16(src + i, n - i, cp);
+            if (units <= 0) return {o, i, units < 0 ? transcode_status::incomplete_sequence : transcode_status::invalid_sequence};
+            if (o == cap) return {o, i, transcode_status::output_too_small};
+            dst[o++] = static_cast<D>(cp);
+            i += static_cast<std::size_t>(units);
+        }
+        return {o, i, transcode_status::ok};
+    }
+
+
+    /// @brief Transcodes 32-bit code units into 16-bit code units
+    /// @param cap Room in `dst`; `utf16_length_from_utf32` is always sufficient
+    template <typename S, typename D>
+        requires(sizeof(S) == 4 && sizeof(D) == 2)
+    inline transcode_result utf32_to_utf16(const S* src, std::size_t n, D* dst, std::size_t cap) noexcept
+    {
+        std::size_t o {0};
+        for (std::size_t i = 0; i < n; i++) {
+            const auto c = static_cast<std::uint32_t>(src[i]);
+            if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) return {o, i, transcode_status::invalid_sequence};
+            if (c < 0x10000) {
+                if (o == cap) return {o, i, transcode_status::output_too_small};
+                dst[o++] = static_cast<D>(c);
+            }
+            else {
+                if (cap - o < 2) return {o, i, transcode_status::output_too_small};
+                dst[o++] = static_cast<D>(0xD800 + ((c - 0x10000) >> 10));
+                dst[o++] = static_cast<D>(0xDC00 + ((c - 0x10000) & 0x3FF));
+            }
+        }
+        return {o, n, transcode_status::ok};
+    }
+
+
+    /*
+        Validation
+
+        The vector validators check 32-byte (AVX2) or 16-byte (NEON) blocks using the nibble lookup
+        tables from Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte" (2021),
+        and return the offset of the first block they could not vouch for. `validate_utf8` resumes
+        from the code point boundary just before that offset with the scalar decoder, which both
+        finishes the tail and pins down the exact position of the first error.
+    */
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+    SIDDIQSOFT_TARGET_AVX2 inline std::size_t validate_utf8_avx2(const char* s, std::size_t n) noexcept
+    {
+        // Error bits: 0x01 too short, 0x02 too long, 0x04 overlong 3, 0x08 too large, 0x10 surrogate,
+        // 0x20 overlong 2, 0x40 too large (1000____) or overlong 4, 0x80 two continuations.
+        const __m256i byte1High = _mm256_setr_epi8(0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+                                                   char(0x80), char(0x80), char(0x80), char(0x80), 0x21, 0x01, 0x15, 0x49,
+                                                   0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+                                                   char(0x80), char(0x80), char(0x80), char(0x80), 0x21, 0x01, 0x15, 0x49);
+        const __m256i byte1Low  = _mm256_setr_epi8(char(0xE7), char(0xA3), char(0x83), char(0x83), char(0x8B), char(0xCB), char(0xCB), char(0xCB),
+                                                   char(0xCB), char(0xCB), char(0xCB), char(0xCB), char(0xCB), char(0xDB), char(0xCB), char(0xCB),
+                                                   char(0xE7), char(0xA3), char(0x83), char(0x83), char(0x8B), char(0xCB), char(0xCB), char(0xCB),
+                                                   char(0xCB), char(0xCB), char(0xCB), char(0xCB), char(0xCB), char(0xDB), char(0xCB), char(0xCB));
+        const __m256i byte2High = _mm256_setr_epi8(0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+                                                   char(0xE6), char(0xAE), char(0xBA), char(0xBA), 0x01, 0x01, 0x01, 0x01,
+                                                   0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+                                                   char(0xE6), char(0xAE), char(0xBA), char(0xBA), 0x01, 0x01, 0x01, 0x01);
+        // A lead byte in the last three positions still expects continuation bytes from the next block.
+        const __m256i maxValue = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                  char(0xEF), char(0xDF), char(0xBF));
+        const __m256i nibble   = _mm256_set1_epi8(0x0F);
+
+        __m256i     prev           = _mm256_setzero_si256();
+        __m256i     prevIncomplete = _mm256_setzero_si256();
+        std::size_t i              = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            if (_mm256_movemask_epi8(in) == 0) {
+                if (!_mm256_testz_si256(prevIncomplete, prevIncomplete)) return i;
+                prev = in;
+                continue;
+            }
+
+            const __m256i carry = _mm256_permute2x128_si256(prev, in, 0x21);
+            const __m256i prev1 = _mm256_alignr_epi8(in, carry, 15);
+            const __m256i prev2 = _mm256_alignr_epi8(in, carry, 14);
+            const __m256i prev3 = _mm256_alignr_epi8(in, carry, 13);
+
+            const __m256i sc = _mm256_and_si256(
+                    _mm256_and_si256(_mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                                     _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, nibble))),
+                    _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble)));
+            const __m256i must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(0x60)),
+                                                   _mm256_subs_epu8(prev3, _mm256_set1_epi8(0x70)));
+            const __m256i error  = _mm256_xor_si256(_mm256_and_si256(must23, _mm256_set1_epi8(char(0x80))), sc);
+            if (!_mm256_testz_si256(error, error)) return i;
+
+            prevIncomplete = _mm256_subs_epu8(in, maxValue);
+            prev           = in;
+        }
+        return i;
+    }
+#endif
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+    inline std::size_t validate_utf8_neon(const char* s, std::size_t n) noexcept
+    {
+        // Same tables as the AVX2 validator.
+        static constexpr std::uint8_t byte1HighTable[16] {
+                0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x80, 0x80, 0x80, 0x80, 0x21, 0x01, 0x15, 0x49};
+        static constexpr std::uint8_t byte1LowTable[16] {
+                0xE7, 0xA3, 0x83, 0x83, 0x8B, 0xCB, 0xCB, 0xCB, 0xCB, 0xCB, 0xCB, 0xCB, 0xCB, 0xDB, 0xCB, 0xCB};
+        static constexpr std::uint8_t byte2HighTable[16] {
+                0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xE6, 0xAE, 0xBA, 0xBA, 0x01, 0x01, 0x01, 0x01};
+        static constexpr std::uint8_t maxValueTable[16] {
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF};
+
+        const uint8x16_t byte1High = vld1q_u8(byte1HighTable);
+        const uint8x16_t byte1Low  = vld1q_u8(byte1LowTable);
+        const uint8x16_t byte2High = vld1q_u8(byte2HighTable);
+        const uint8x16_t maxValue  = vld1q_u8(maxValueTable);
+
+        uint8x16_t  prev           = vdupq_n_u8(0);
+        uint8x16_t  prevIncomplete = vdupq_n_u8(0);
+        std::size_t i              = 0;
+        for (; i + 16 <= n; i += 16) {
+            const uint8x16_t in = vld1q_u8(reinterpret_cast<const std::uint8_t*>(s + i));
+            if (vmaxvq_u8(in) < 0x80) {
+                if (vmaxvq_u8(prevIncomplete) != 0) return i;
+                prev = in;
+                continue;
+            }
+
+            const uint8x16_t prev1 = vextq_u8(prev, in, 15);
+            const uint8x16_t prev2 = vextq_u8(prev, in, 14);
+            const uint8x16_t prev3 = vextq_u8(prev, in, 13);
+
+            const uint8x16_t sc     = vandq_u8(vandq_u8(vqtbl1q_u8(byte1High, vshrq_n_u8(prev1, 4)),
+                                                        vqtbl1q_u8(byte1Low, vandq_u8(prev1, vdupq_n_u8(0x0F)))),
+                                               vqtbl1q_u8(byte2High, vshrq_n_u8(in, 4)));
+            const uint8x16_t must23 = vorrq_u8(vqsubq_u8(prev2, vdupq_n_u8(0x60)), vqsubq_u8(prev3, vdupq_n_u8(0x70)));
+            const uint8x16_t error  = veorq_u8(vandq_u8(must23, vdupq_n_u8(0x80)), sc);
+            if (vmaxvq_u8(error) != 0) return i;
+
+            prevIncomplete = vqsubq_u8(in, maxValue);
+            prev           = in;
+        }
+        return i;
+    }
+#endif
+
+
+    /// @brief Validates `s` from `i` (a code point boundary) to `n` one word or sequence at a time.
+    /// Kept out of line: inlined into a caller that passes a short literal, the word loop below is
+    /// reported by GCC as reading past the literal (-Warray-bounds) even though `i + 8 <= n` rules it out.
+    SIDDIQSOFT_NOINLINE inline transcode_result validate_utf8_scalar(const char* s, std::size_t n, std::size_t i) noexcept
+    {
+        while (i < n) {
+            // Eight bytes at a time through ASCII text
+            while (i + 8 <= n) {
+                std::uint64_t word {};
+                std::memcpy(&word, s + i, sizeof(word));
+                if ((word & 0x8080808080808080ULL) != 0) break;
+                i += 8;
+            }
+            if (i >= n) break;
+
+            char32_t  cp {};
+            const int len = decode_utf8(s + i, n - i, cp);
+            if (len <= 0) return {0, i, len < 0 ? transcode_status::incomplete_sequence : transcode_status::invalid_sequence};
+            i += static_cast<std::size_t>(len);
+        }
+        return {0, n, transcode_status::ok};
+    }
+
+
+    /// @brief Validates UTF-8 without allocating.
+    /// @return `consumed` is the offset of the first invalid (or incomplete) sequence, or `n` when valid
+    inline transcode_result validate_utf8(const char* s, std::size_t n) noexcept
+    {
+        using block_validator = std::size_t (*)(const char*, std::size_t) noexcept;
+        static const block_validator blocks = []() noexcept -> block_validator {
+            switch (detected_simd_level()) {
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+                case simd_level::avx2: return &validate_utf8_avx2;
+#endif
+#if defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+                case simd_level::neon: return &validate_utf8_neon;
+#endif
+                default: return nullptr;
+            }
+        }();
+
+        // Resume at the code point boundary before the last three vouched-for bytes: a sequence
+        // that straddles the block edge has only been partially checked.
+        std::size_t i = (blocks != nullptr) ? blocks(s, n) : 0;
+        i             = (i > 3) ? i - 3 : 0;
+        for (int k = 0; k < 3 && i > 0 && (static_cast<unsigned char>(s[i]) & 0xC0) == 0x80; k++) i--;
+        return validate_utf8_scalar(s, n, i);
+    }
+
+
+
+    /// @brief Validates UTF-16 (unpaired surrogates) without allocating.
+    /// @return `consumed` is the offset (in code units) of the first unpaired surrogate, or `n` when valid
+    template <typename U>
+        requires(sizeof(U) == 2)
+    inline transcode_result validate_utf16(const U* s, std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+        while (i < n) {
+            // Skip blocks without any surrogate code unit
+#if defined(SIDDIQSOFT_STRINGHELPERS_X86)
+            const __m128i mask = _mm_set1_epi16(static_cast<short>(0xF800));
+            const __m128i surr = _mm_set1_epi16(static_cast<short>(0xD800));
+            while (i + 8 <= n) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, mask), surr)) != 0) break;
+                i += 8;
+            }
+#elif defined(SIDDIQSOFT_STRINGHELPERS_NEON)
+            while (i + 8 <= n) {
+                const uint16x8_t v = vld1q_u16(reinterpret_cast<const std::uint16_t*>(s + i));
+                if (vmaxvq_u16(vceqq_u16(vandq_u16(v, vdupq_n_u16(0xF800)), vdupq_n_u16(0xD800))) != 0) break;
+                i += 8;
+            }
+#endif
+            // Scalar through the block that holds a surrogate (or the tail)
+            const std::size_t end = (i + 8 < n) ? i + 8 : n;
+            while (i < end) {
+                char32_t  cp {};
+                const int units = decode_utf16(s + i, n - i, cp);
+                if (units <= 0) return {0, i, units < 0 ? transcode_status::incomplete_sequence : transcode_status::invalid_sequence};
+                i += static_cast<std::size_t>(units);
+            }
+        }
+        return {0, n, transcode_status::ok};
+    }
+
+
+
+    /// @brief Validates 32-bit code units (no surrogates, nothing beyond U+10FFFF)
+    template <typename U>
+        requires(sizeof(U) == 4)
+    inline transcode_result validate_utf32(const U* s, std::size_t n) noexcept
+    {
+        for (std::size_t i = 0; i < n; i++) {
+            const auto c = static_cast<std::uint32_t>(s[i]);
+            if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) return {0, i, transcode_status::invalid_sequence};
+        }
+        return {0, n, transcode_status::ok};
+    }
+
+    /*
+        Encoding dispatch
+
+        Every pair of character types maps onto one of the kernels above at compile time. The
+        width of wchar_t decides its encoding: UTF-16 on Windows, UTF-32 on Linux and Darwin.
+    */
+
+    /// @brief Unicode encoding form used by a character type
+    enum class encoding
+    {
+        utf8,
+        utf16,
+        utf32
+    };
+
+    template <typename C>
+    concept unicode_char = std::same_as<C, char> || std::same_as<C, char8_t> || std::same_as<C, char16_t> ||
+                           std::same_as<C, char32_t> || std::same_as<C, wchar_t>;
+
+    template <unicode_char C>
+    inline constexpr encoding encoding_of = sizeof(C) == 1 ? encoding::utf8 : sizeof(C) == 2 ? encoding::utf16 : encoding::utf32;
+
+
+    /// @brief UTF-8 kernels operate on char; char8_t buffers are accessed through char (always allowed to alias)
+    template <typename C>
+    inline const char* as_chars(const C* p) noexcept
+    {
+        return reinterpret_cast<const char*>(p);
+    }
+
+    template <typename C>
+    inline char* as_chars(C* p) noexcept
+    {
+        return reinterpret_cast<char*>(p);
+    }
+
+
+    /// @brief Exact number of D code units needed to transcode `src` (assumes the input is valid)
+    template <unicode_char S, unicode_char D>
+    inline std::size_t transcoded_length(const S* src, std::size_t n) noexcept
+    {
+        constexpr auto from = encoding_of<S>;
+        constexpr auto to   = encoding_of<D>;
+
+        if constexpr (from == to) return n;
+        else if constexpr (from == encoding::utf8 && to == encoding::utf16) return utf16_length_from_utf8(as_chars(src), n);
+        else if constexpr (from == encoding::utf8 && to == encoding::utf32) return utf32_length_from_utf8(as_chars(src), n);
+        else if constexpr (from == encoding::utf16 && to == encoding::utf8) return utf8_length_from_utf16(src, n);
+        else if constexpr (from == encoding::utf16 && to == encoding::utf32) return utf32_length_from_utf16(src, n);
+        else if constexpr (from == encoding::utf32 && to == encoding::utf8) return utf8_length_from_utf32(src, n);
+        else return utf16_length_from_utf32(src, n);
+    }
+
+
+    /// @brief Room in D code units that always holds the transcoded `src`. From UTF-8 (and UTF-16 to UTF-32)
+    /// no sequence yields more units than it takes, so `n` is returned without reading the input; for the
+    /// pairs whose bound would overshoot ASCII text several times over the exact length is measured.
+    template <unicode_char S, unicode_char D>
+    inline std::size_t transcode_capacity(const S* src, std::size_t n) noexcept
+    {
+        constexpr auto from = encoding_of<S>;
+        constexpr auto to   = encoding_of<D>;
+
+        if constexpr (from == to || from == encoding::utf8 || (from == encoding::utf16 && to == encoding::utf32)) return n;
+        else return transcoded_length<S, D>(src, n);
+    }
+
+
+    /// @brief Number of units to discard at an invalid or incomplete sequence: the maximal subpart
+    /// (the longest prefix of a well-formed sequence, at least one unit) per Unicode ch. 3 "U+FFFD Substitution".
+    template <unicode_char S>
+    inline std::size_t invalid_length(const S* src, std::size_t n) noexcept
+    {
+        if constexpr (encoding_of<S> == encoding::utf8) {
+            const auto        b0  = static_cast<unsigned char>(src[0]);
+            const std::size_t len = utf8_sequence_length(static_cast<char>(src[0]));
+            unsigned char     lo {0x80}, hi {0xBF};
+            if (b0 == 0xE0) lo = 0xA0;
+            if (b0 == 0xED) hi = 0x9F;
+            if (b0 == 0xF0) lo = 0x90;
+            if (b0 == 0xF4) hi = 0x8F;
+
+            std::size_t k = 1;
+            for (; k < len && k < n; k++) {
+                const auto b = static_cast<unsigned char>(src[k]);
+                if (b < lo || b > hi) break;
+                lo = 0x80;
+                hi = 0xBF;
+            }
+            return k;
+        }
+        else {
+            return 1;
+        }
+    }
+
+
+    /// @brief The first position at or after `pos` where `src` can be cut without splitting a sequence:
+    /// skips at most three UTF-8 continuation bytes or one UTF-16 low surrogate.
+    template <unicode_char S>
+    inline std::size_t split_point(const S* src, std::size_t n, std::size_t pos) noexcept
+    {
+        if constexpr (encoding_of<S> == encoding::utf8) {
+            for (std::size_t k = 0; k < 3 && pos < n && (static_cast<unsigned char>(src[pos]) & 0xC0) == 0x80; k++) pos++;
+        }
+        else if constexpr (encoding_of<S> == encoding::utf16) {
+            if (pos < n && (static_cast<std::uint32_t>(src[pos]) & 0xFC00) == 0xDC00) pos++;
+        }
+        return pos < n ? pos : n;
+    }
+
+
+    /// @brief Units taken by U+FFFD REPLACEMENT CHARACTER in the encoding of D
+    template <unicode_char D>
+    inline constexpr std::size_t replacement_length = encoding_of<D> == encoding::utf8 ? 3 : 1;
+
+
+    /// @brief Writes U+FFFD REPLACEMENT CHARACTER (`replacement_length<D>` units) into `dst`
+    template <unicode_char D>
+    inline void write_replacement(D* dst) noexcept
+    {
+        if constexpr (encoding_of<D> == encoding::utf8) {
+            dst[0] = static_cast<D>(0xEF);
+            dst[1] = static_cast<D>(0xBF);
+            dst[2] = static_cast<D>(0xBD);
+        }
+        else {
+            dst[0] = static_cast<D>(0xFFFD);
+        }
+    }
+
+
+    /// @brief Validates `n` units of S in its encoding without allocating
+    template <unicode_char S>
+    inline transcode_result validate(const S* src, std::size_t n) noexcept
+    {
+        if constexpr (encoding_of<S> == encoding::utf8) return validate_utf8(as_chars(src), n);
+        else if constexpr (encoding_of<S> == encoding::utf16) return validate_utf16(src, n);
+        else return validate_utf32(src, n);
+    }
+
+
+    /*
+        Portable scalar transcoder
+
+        One code point at a time through the same decode/encode primitives as the kernels above. It is
+        usable in constant expressions (ConversionUtils::ct_convert) and is what `transcode` runs when
+        evaluated at compile time.
+    */
+
+    /// @brief Decodes the code point at `s` in the encoding of S
+    /// @return Units used, 0 when invalid or -1 when the input ends mid-sequence
+    template <unicode_char S>
+    constexpr int decode(const S* s, std::size_t n, char32_t& cp) noexcept
+    {
+        if constexpr (encoding_of<S> == encoding::utf8) return decode_utf8(s, n, cp);
+        else if constexpr (encoding_of<S> == encoding::utf16) return decode_utf16(s, n, cp);
+        else {
+            cp = static_cast<char32_t>(s[0]);
+            return (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) ? 0 : 1;
+        }
+    }
+
+
+    /// @brief Encodes the scalar value `cp` in the encoding of D into `d` (room for 4 units required)
+    /// @return Units written
+    template <unicode_char D>
+    constexpr int encode(char32_t cp, D* d) noexcept
+    {
+        if constexpr (encoding_of<D> == encoding::utf8) return encode_utf8(cp, d);
+        else if constexpr (encoding_of<D> == encoding::utf16) {
+            if (cp < 0x10000) {
+                d[0] = static_cast<D>(cp);
+                return 1;
+            }
+            d[0] = static_cast<D>(0xD800 + ((cp - 0x10000) >> 10));
+            d[1] = static_cast<D>(0xDC00 + ((cp - 0x10000) & 0x3FF));
+            return 2;
+        }
+        else {
+            d[0] = static_cast<D>(cp);
+            return 1;
+        }
+    }
+
+
+    /// @brief Transcodes `n` units of S into at most `cap` units of D without vector kernels
+    /// @param dst Destination; may be null to only count the output (`written`)
+    template <unicode_char S, unicode_char D>
+    constexpr transcode_result transcode_scalar(const S* src, std::size_t n, D* dst, std::size_t cap) noexcept
+    {
+        std::size_t i {0}, o {0};
+        while (i < n) {
+            char32_t  cp {};
+            const int units = decode(src + i, n - i, cp);
+            if (units <= 0) return {o, i, units < 0 ? transcode_status::incomplete_sequence : transcode_status::invalid_sequence};
+
+            D         unit[4] {};
+            const int count = encode(cp, unit);
+            if (cap - o < static_cast<std::size_t>(count)) return {o, i, transcode_status::output_too_small};
+            for (int k = 0; k < count; k++) {
+                if (dst != nullptr) dst[o] = unit[k];
+                o++;
+            }
+            i += static_cast<std::size_t>(units);
+        }
+        return {o, i, transcode_status::ok};
+    }
+
+
+    /// @brief Copies code units between two types that share an encoding (char/char8_t, char16_t/wchar_t, ...),
+    /// stopping at the first invalid or incomplete sequence like the other kernels
+    template <typename S, typename D>
+        requires(sizeof(S) == sizeof(D))
+    inline transcode_result copy_units(const S* src, std::size_t n, D* dst, std::size_t cap) noexcept
+    {
+        const std::size_t m  = n < cap ? n : cap;
+        const auto        rc = validate(src, m);
+        for (std::size_t i = 0; i < rc.consumed; i++) dst[i] = static_cast<D>(src[i]);
+
+        // A sequence cut by `cap` rather than by the end of the input needs more room, not a verdict
+        if (m < n && rc.status != transcode_status::invalid_sequence) {
+            return {rc.consumed, rc.consumed, transcode_status::output_too_small};
+        }
+        return {rc.consumed, rc.consumed, rc.status};
+    }
+
+
+    /// @brief The kernel for the encoding pair S to D
+    template <unicode_char S, unicode_char D>
+    inline transcode_result transcode_kernel(const S* src, std::size_t n, D* dst, std::size_t cap) noexcept
+    {
+        constexpr auto from = encoding_of<S>;
+        constexpr auto to   = encoding_of<D>;
+
+        if constexpr (from == to) return copy_units(src, n, dst, cap);
+        else if constexpr (from == encoding::utf8 && to == encoding::utf16) return utf8_to_utf16(as_chars(src), n, dst, cap);
+        else if constexpr (from == encoding::utf8 && to == encoding::utf32) return utf8_to_utf32(as_chars(src), n, dst, cap);
+        else if constexpr (from == encoding::utf16 && to == encoding::utf8) return utf16_to_utf8(src, n, as_chars(dst), cap);
+        else if constexpr (from == encoding::utf16 && to == encoding::utf32) return utf16_to_utf32(src, n, dst, cap);
+        else if constexpr (from == encoding::utf32 && to == encoding::utf8) return utf32_to_utf8(src, n, as_chars(dst), cap);
+        else return utf32_to_utf16(src, n, dst, cap);
+    }
+
+
+    /// @brief Transcodes `n` units of S into at most `cap` units of D using the kernel for the encoding pair
+    template <unicode_char S, unicode_char D>
+    constexpr transcode_result transcode(const S* src, std::size_t n, D* dst, std::size_t cap) noexcept
+    {
+        if (std::is_constant_evaluated()) return transcode_scalar(src, n, dst, cap);
+
+        const auto rc = transcode_kernel(src, n, dst, cap);
+        stats::on_bytes(rc.consumed * sizeof(S), rc.written * sizeof(D));
+        return rc;
+    }
+} // namespace siddiqsoft::utf
+
+#endif
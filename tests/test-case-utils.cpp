@@ -0,0 +1,154 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include "gtest/gtest.h"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "../include/siddiqsoft/case-utils.hpp"
+#include "../include/siddiqsoft/conversion-utils.hpp"
+
+
+namespace siddiqsoft
+{
+    TEST(CaseUtils, fold_code_points)
+    {
+        EXPECT_EQ(U'a', CaseUtils::fold(U'A'));
+        EXPECT_EQ(U'[', CaseUtils::fold(U'['));
+        EXPECT_EQ(U'\x00E9', CaseUtils::fold(U'\x00C9'));
+        EXPECT_EQ(U'\x0101', CaseUtils::fold(U'\x0100'));
+        EXPECT_EQ(U'\x0101', CaseUtils::fold(U'\x0101'));
+        EXPECT_EQ(U'\x03C3', CaseUtils::fold(U'\x03C2')); // final sigma
+        EXPECT_EQ(U'\x00DF', CaseUtils::fold(U'\x1E9E')); // capital sharp s (simple folding)
+        EXPECT_EQ(U'k', CaseUtils::fold(U'\x212A'));      // Kelvin sign
+        EXPECT_EQ(U'\x2C65', CaseUtils::fold(U'\x023A'));
+        EXPECT_EQ(U'\x0130', CaseUtils::fold(U'\x0130')); // only full/Turkic foldings
+        EXPECT_EQ(U'\x10428', CaseUtils::fold(U'\x10400'));
+        EXPECT_EQ(U'\x4E16', CaseUtils::fold(U'\x4E16'));
+    }
+
+    TEST(CaseUtils, fold_strings)
+    {
+        EXPECT_EQ("content-type: caf\xC3\xA9", CaseUtils::fold("Content-Type: CAF\xC3\x89"));
+        EXPECT_EQ(L"x-ms-date \x03C3\x03C3", CaseUtils::fold<wchar_t>(L"X-MS-Date \x03A3\x03C2"));
+        EXPECT_EQ(u"k\x2C65", CaseUtils::fold<char16_t>(u"\x212A\x023A"));
+        EXPECT_EQ("k\xE2\xB1\xA5", CaseUtils::fold("\xE2\x84\xAA\xC8\xBA")); // length changes both ways in UTF-8
+
+        // Long input crosses the vector blocks; malformed bytes are kept
+        std::string src(100, 'A');
+        src[50] = '\xFF';
+        std::string expected(100, 'a');
+        expected[50] = '\xFF';
+        EXPECT_EQ(expected, CaseUtils::fold(src));
+
+        std::u8string out {u8">"};
+        CaseUtils::fold_into<char8_t>(u8"ÀB", out);
+        EXPECT_TRUE(out == u8">àb");
+    }
+
+    TEST(CaseUtils, iequals)
+    {
+        EXPECT_TRUE(CaseUtils::iequals("Content-Length", "content-LENGTH"));
+        EXPECT_FALSE(CaseUtils::iequals("Content-Length", "Content-Lengt"));
+        EXPECT_FALSE(CaseUtils::iequals("a", "b"));
+        EXPECT_FALSE(CaseUtils::iequals("@", "`")); // differ only in bit 0x20 but are not letters
+        EXPECT_TRUE(CaseUtils::iequals("", ""));
+        EXPECT_TRUE(CaseUtils::iequals("CAF\xC3\x89", "caf\xC3\xA9"));
+        EXPECT_TRUE(CaseUtils::iequals("\xE2\x84\xAA" "elvin", "KELVIN")); // different UTF-8 lengths
+        EXPECT_TRUE(CaseUtils::iequals<wchar_t>(L"\x039F\x0394\x03A5\x03A3\x03A3\x0395\x038E\x03A3", L"\x03BF\x03B4\x03C5\x03C3\x03C3\x03B5\x03CD\x03C2"));
+        EXPECT_TRUE(CaseUtils::iequals<char16_t>(u"\U00010400x", u"\U00010428X"));
+        EXPECT_FALSE(CaseUtils::iequals<char32_t>(U"stra\x00DF" U"e", U"STRASSE")); // simple folding only
+        EXPECT_TRUE(CaseUtils::iequals("\xFF" "A", "\xFF" "a"));
+        EXPECT_FALSE(CaseUtils::iequals("\xFF", "\xFE"));
+    }
+
+    TEST(CaseUtils, iequals_at_every_offset)
+    {
+        for (size_t pos = 0; pos < 100; pos++) {
+            std::string  a(100, 'x'), b(100, 'X');
+            std::wstring wa(100, L'x'), wb(100, L'X');
+            EXPECT_TRUE(CaseUtils::iequals(a, b)) << pos;
+
+            b[pos] = 'Y';
+            wb[pos] = L'Y';
+            EXPECT_FALSE(CaseUtils::iequals(a, b)) << pos;
+            EXPECT_FALSE(CaseUtils::iequals<wchar_t>(wa, wb)) << pos;
+            a[pos] = 'y';
+            wa[pos] = L'y';
+            EXPECT_TRUE(CaseUtils::iequals(a, b)) << pos;
+            EXPECT_TRUE(CaseUtils::iequals<wchar_t>(wa, wb)) << pos;
+
+            wa[pos] = L'\x00C9';
+            wb[pos] = L'\x00E9';
+            EXPECT_TRUE(CaseUtils::iequals<wchar_t>(wa, wb)) << pos;
+            wb[pos] = L'\x00EA';
+            EXPECT_FALSE(CaseUtils::iequals<wchar_t>(wa, wb)) << pos;
+        }
+    }
+
+    TEST(CaseUtils, ihash)
+    {
+        EXPECT_EQ(CaseUtils::ihash("Content-Type"), CaseUtils::ihash("CONTENT-type"));
+        EXPECT_NE(CaseUtils::ihash("Content-Type"), CaseUtils::ihash("Content-Typo"));
+        EXPECT_NE(CaseUtils::ihash(""), CaseUtils::ihash(std::string_view {"\0", 1}));
+
+        // The same text hashes the same in every encoding, across several hash blocks
+        std::u32string text;
+        for (char32_t cp = 0x20; cp < 0x600; cp += 3) text += cp;
+        text += U"\U0001F600 \x212A \x1E9E";
+        auto folded = ConversionUtils::convert_to<char32_t, char>(CaseUtils::fold<char32_t>(text));
+        auto hash   = CaseUtils::ihash<char32_t>(text);
+
+        EXPECT_EQ(hash, CaseUtils::ihash(folded));
+        EXPECT_EQ(hash, CaseUtils::ihash(ConversionUtils::convert_to<char32_t, char>(text)));
+        EXPECT_EQ(hash, CaseUtils::ihash<char16_t>(ConversionUtils::convert_to<char32_t, char16_t>(text)));
+        EXPECT_EQ(hash, CaseUtils::ihash<wchar_t>(ConversionUtils::convert_to<char32_t, wchar_t>(text)));
+    }
+
+    TEST(CaseUtils, header_map)
+    {
+        std::unordered_map<std::string, int, case_insensitive_hash<char>, case_insensitive_equal_to<char>> headers {
+                {"Content-Type", 1}, {"Content-Length", 2}};
+        EXPECT_EQ(1, headers.at("content-type"));
+        EXPECT_EQ(2, headers.at("CONTENT-LENGTH"));
+        EXPECT_FALSE(headers.contains("content-encoding"));
+        EXPECT_FALSE(headers.emplace("content-type", 3).second);
+
+        std::unordered_map<std::wstring, int, case_insensitive_hash<wchar_t>, case_insensitive_equal_to<wchar_t>> wide {{L"X-MS-Date", 1}};
+        EXPECT_TRUE(wide.contains(std::wstring_view {L"x-ms-date"}));
+    }
+} // namespace siddiqsoft
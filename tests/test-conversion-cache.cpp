@@ -0,0 +1,127 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+
+#include "gtest/gtest.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/siddiqsoft/conversion-cache.hpp"
+
+
+namespace siddiqsoft
+{
+    TEST(ConversionCache, hit_returns_shared_result)
+    {
+        ConversionCache<char, wchar_t> cache;
+
+        auto first  = cache.get("Content-Type");
+        auto second = cache.get(std::string {"Content-Type"});
+        EXPECT_EQ(std::wstring(L"Content-Type"), *first);
+        EXPECT_EQ(first.get(), second.get());
+
+        auto stats = cache.stats();
+        EXPECT_EQ(1u, stats.hits);
+        EXPECT_EQ(1u, stats.misses);
+        EXPECT_EQ(1u, stats.size);
+    }
+
+    TEST(ConversionCache, bounded_with_clock_eviction)
+    {
+        // One shard of four entries so the eviction order is predictable
+        ConversionCache<char, char16_t> cache(4, 1);
+        for (auto key : {"a", "b", "c", "d"}) cache.get(key);
+
+        // Touch "a"; the next insert evicts "b", the first entry without a second chance
+        cache.get("a");
+        cache.get("e");
+
+        auto stats = cache.stats();
+        EXPECT_EQ(4u, stats.size);
+        EXPECT_EQ(1u, stats.evictions);
+
+        cache.get("a");
+        EXPECT_EQ(2u, cache.stats().hits);
+        cache.get("b");
+        EXPECT_EQ(6u, cache.stats().misses);
+    }
+
+    TEST(ConversionCache, results_outlive_eviction_and_clear)
+    {
+        ConversionCache<char16_t, char> cache(1, 1);
+        auto                            kept = cache.get(u"été");
+        cache.get(u"other");
+        cache.clear();
+        EXPECT_EQ(std::string("\xC3\xA9t\xC3\xA9"), *kept);
+        EXPECT_EQ(0u, cache.stats().size);
+    }
+
+    TEST(ConversionCache, long_and_malformed_inputs_are_not_cached)
+    {
+        ConversionCache<char, wchar_t> cache(16, 2, 8);
+
+        EXPECT_EQ(std::wstring(L"0123456789"), *cache.get("0123456789"));
+        EXPECT_EQ(1u, cache.stats().bypassed);
+
+        EXPECT_THROW(cache.get("bad\xFF"), std::range_error);
+        EXPECT_EQ(0u, cache.stats().size);
+    }
+
+    TEST(ConversionCache, concurrent_get)
+    {
+        ConversionCache<char, wchar_t> cache(64, 8);
+        std::vector<std::string>       keys;
+        for (int i = 0; i < 100; i++) keys.push_back("x-header-" + std::to_string(i));
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&] {
+                for (int round = 0; round < 50; round++) {
+                    for (auto& k : keys) {
+                        auto v = cache.get(k);
+                        ASSERT_EQ(k.size(), v->size());
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        auto stats = cache.stats();
+        EXPECT_EQ(4u * 50 * keys.size(), stats.hits + stats.misses);
+        EXPECT_LE(stats.size, 64u);
+    }
+} // namespace siddiqsoft
@@ -0,0 +1,111 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "gtest/gtest.h"
+#include <string>
+#include <thread>
+
+#include "../include/siddiqsoft/conversion-stats.hpp"
+#include "../include/siddiqsoft/conversion-utils.hpp"
+
+
+namespace siddiqsoft
+{
+    TEST(ConversionStats, counts_conversions)
+    {
+        const std::string text {"GET /objects/container/blob.txt HTTP/1.1"};
+
+        stats::reset();
+        auto wide = ConversionUtils::convert_to<char, char16_t>(text);
+        auto bad  = ConversionUtils::convert_to<char, char16_t, error_policy::replace>("a\xFF" "b");
+        EXPECT_EQ(u"a\xFFFD" "b", bad);
+        auto same = ConversionUtils::convert_to<char8_t, char16_t>(u8"ok");
+        EXPECT_EQ(u"ok", same);
+
+        const auto snap = stats::snapshot();
+        if constexpr (!stats::enabled) {
+            // Compiled out: nothing is counted
+            EXPECT_EQ(0u, snap.total_calls());
+            EXPECT_EQ(0u, snap.bytes_in);
+            EXPECT_EQ(0u, snap.errors);
+            return;
+        }
+
+        // char and char8_t share an encoding but are counted apart
+        EXPECT_EQ(2u, (snap.calls[stats::type_index<char>][stats::type_index<char16_t>]));
+        EXPECT_EQ(1u, (snap.calls[stats::type_index<char8_t>][stats::type_index<char16_t>]));
+        EXPECT_EQ(3u, snap.total_calls());
+        // The malformed byte is skipped by the policy, not consumed by the transcoder
+        EXPECT_EQ(text.size() + 4, snap.bytes_in);
+        EXPECT_EQ((text.size() + 4) * sizeof(char16_t), snap.bytes_out);
+        EXPECT_EQ(text.size() + 4, snap.ascii_bytes);
+        EXPECT_DOUBLE_EQ(1.0, snap.ascii_ratio());
+        // The short result fits the string's own buffer
+        EXPECT_EQ(1u, snap.allocations);
+        EXPECT_EQ(1u, snap.errors);
+    }
+
+    TEST(ConversionStats, every_thread_and_reset)
+    {
+        stats::reset();
+        std::thread worker {[] {
+            auto out = ConversionUtils::convert_to<char32_t, char>(U"caf\x00E9");
+            EXPECT_EQ("caf\xC3\xA9", out);
+        }};
+        worker.join();
+        auto out = ConversionUtils::convert_to<char16_t, char32_t, error_policy::report>(u"\xD800");
+        EXPECT_FALSE(out.has_value());
+
+        auto snap = stats::snapshot();
+        if constexpr (stats::enabled) {
+            // The worker's counters outlive the thread
+            EXPECT_EQ(1u, (snap.calls[stats::type_index<char32_t>][stats::type_index<char>]));
+            EXPECT_EQ(1u, (snap.calls[stats::type_index<char16_t>][stats::type_index<char32_t>]));
+            EXPECT_EQ(0u, (snap.calls[stats::type_index<wchar_t>][stats::type_index<char>]));
+            EXPECT_EQ(16u, snap.bytes_in);
+            EXPECT_EQ(5u, snap.bytes_out);
+            EXPECT_EQ(12u, snap.ascii_bytes);
+            EXPECT_DOUBLE_EQ(0.75, snap.ascii_ratio());
+            EXPECT_EQ(1u, snap.errors);
+        }
+
+        stats::reset();
+        snap = stats::snapshot();
+        EXPECT_EQ(0u, snap.total_calls());
+        EXPECT_EQ(0u, snap.bytes_in);
+        EXPECT_EQ(0u, snap.errors);
+        EXPECT_DOUBLE_EQ(0.0, snap.ascii_ratio());
+    }
+} // namespace siddiqsoft
@@ -0,0 +1,302 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+
+#include "gtest/gtest.h"
+#include <cctype>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../include/siddiqsoft/conversion-utils.hpp"
+#include "../include/siddiqsoft/encoding-utils.hpp"
+
+
+namespace siddiqsoft
+{
+    /// @brief Byte-at-a-time reference encoder
+    static std::string reference_encode(std::string_view src, std::string_view keep)
+    {
+        std::string out;
+        for (unsigned char b : src) {
+            if (std::isalnum(b) && b < 0x80) out += static_cast<char>(b);
+            else if (std::string_view {"-._~"}.find(static_cast<char>(b)) != std::string_view::npos) out += static_cast<char>(b);
+            else if (keep.find(static_cast<char>(b)) != std::string_view::npos) out += static_cast<char>(b);
+            else {
+                char buf[4];
+                std::snprintf(buf, sizeof(buf), "%%%02X", b);
+                out += buf;
+            }
+        }
+        return out;
+    }
+
+    TEST(EncodingUtils, url_encode_components)
+    {
+        std::string_view src {"a b/c?d=e&f+g:h@i#j~k"};
+
+        EXPECT_EQ("a%20b%2Fc%3Fd%3De%26f%2Bg%3Ah%40i%23j~k", EncodingUtils::url_encode(src));
+        EXPECT_EQ("a%20b%2Fc%3Fd=e&f+g:h@i%23j~k", EncodingUtils::url_encode(src, url_component::path_segment));
+        EXPECT_EQ("a%20b/c%3Fd=e&f+g:h@i%23j~k", EncodingUtils::url_encode(src, url_component::path));
+        EXPECT_EQ("a%20b/c?d=e&f+g:h@i%23j~k", EncodingUtils::url_encode(src, url_component::query));
+        EXPECT_EQ("a+b%2Fc%3Fd%3De%26f%2Bg%3Ah%40i%23j~k", EncodingUtils::url_encode(src, url_component::form));
+    }
+
+    TEST(EncodingUtils, url_encode_matches_reference_at_every_offset)
+    {
+        // Long enough for several vector blocks; one unsafe byte moved through every position
+        std::string base(100, 'x');
+        for (size_t pos = 0; pos < base.size(); pos++) {
+            for (char unsafe : {' ', '/', '\x7F', '\x80', '\xFF', '%'}) {
+                std::string src = base;
+                src[pos]        = unsafe;
+                EXPECT_EQ(reference_encode(src, ""), EncodingUtils::url_encode(src)) << pos;
+                EXPECT_EQ(reference_encode(src, "!$&'()*+,;=:@/"), EncodingUtils::url_encode(src, url_component::path)) << pos;
+            }
+        }
+    }
+
+    TEST(EncodingUtils, url_encode_wide_is_fused_utf8)
+    {
+        std::wstring src {L"caf\x00E9 \x4E16/\U0001F600 & more"};
+        auto         narrow = ConversionUtils::convert_to<wchar_t, char>(src);
+
+        EXPECT_EQ(EncodingUtils::url_encode(narrow), EncodingUtils::url_encode<wchar_t>(src));
+        EXPECT_EQ("caf%C3%A9%20%E4%B8%96%2F%F0%9F%98%80%20%26%20more", EncodingUtils::url_encode<wchar_t>(src));
+        EXPECT_EQ(EncodingUtils::url_encode(narrow, url_component::path),
+                  EncodingUtils::url_encode<char16_t>(u"café 世/\U0001F600 & more", url_component::path));
+
+        std::u16string lone {u'a', u'\xD800'};
+        EXPECT_THROW(EncodingUtils::url_encode<char16_t>(lone), std::range_error);
+    }
+
+    TEST(EncodingUtils, url_encode_into_appends)
+    {
+        std::string out {"https://example.blob.core.windows.net/"};
+        EncodingUtils::url_encode_into("my container/blob name.txt", out, url_component::path);
+        EncodingUtils::url_encode_into("?comp=list", out, url_component::query);
+        EXPECT_EQ("https://example.blob.core.windows.net/my%20container/blob%20name.txt?comp=list", out);
+    }
+
+    TEST(EncodingUtils, url_decode)
+    {
+        EXPECT_EQ("a b/c?d=e&f+g", EncodingUtils::url_decode("a%20b%2Fc%3fd%3De%26f+g"));
+        EXPECT_EQ("a b c", EncodingUtils::url_decode("a+b%20c", url_component::form));
+        EXPECT_EQ("caf\xC3\xA9", EncodingUtils::url_decode("caf%C3%A9"));
+        EXPECT_EQ("", EncodingUtils::url_decode(""));
+
+        std::string out {">"};
+        EXPECT_THROW(EncodingUtils::url_decode_into("ok%2", out), std::range_error);
+        EXPECT_EQ(">ok", out);
+        EXPECT_THROW(EncodingUtils::url_decode("%G0"), std::range_error);
+        EXPECT_THROW(EncodingUtils::url_decode("%"), std::range_error);
+    }
+
+    TEST(EncodingUtils, url_roundtrip_long)
+    {
+        std::string src;
+        for (int i = 0; i < 4096; i++) src += static_cast<char>(i % 256);
+
+        for (auto c : {url_component::unreserved, url_component::path, url_component::query, url_component::form}) {
+            EXPECT_EQ(src, EncodingUtils::url_decode(EncodingUtils::url_encode(src, c), c));
+        }
+    }
+
+
+    TEST(EncodingUtils, json_escape)
+    {
+        EXPECT_EQ(R"(say \"hi\"\\n)", EncodingUtils::json_escape(R"(say "hi"\n)"));
+        EXPECT_EQ(R"(a\tb\r\nc\b\f\u0001\u001f/)", EncodingUtils::json_escape("a\tb\r\nc\b\f\x01\x1F/"));
+        EXPECT_EQ("caf\xC3\xA9 \xF0\x9F\x98\x80", EncodingUtils::json_escape("caf\xC3\xA9 \xF0\x9F\x98\x80"));
+        EXPECT_EQ("", EncodingUtils::json_escape(""));
+        EXPECT_THROW(EncodingUtils::json_escape("bad \xC3"), std::range_error);
+    }
+
+    TEST(EncodingUtils, json_escape_at_every_offset)
+    {
+        // One special byte moved through several vector blocks
+        std::string base(100, 'x');
+        for (size_t pos = 0; pos < base.size(); pos++) {
+            for (auto [raw, escaped] : std::vector<std::pair<char, std::string_view>> {
+                         {'"', R"(\")"}, {'\\', R"(\\)"}, {'\n', R"(\n)"}, {'\x1F', R"(\u001f)"}, {'\0', R"(\u0000)"}}) {
+                std::string src = base;
+                src[pos]        = raw;
+                std::string expected = base.substr(0, pos) + std::string(escaped) + base.substr(pos + 1);
+                EXPECT_EQ(expected, EncodingUtils::json_escape(src)) << pos;
+                EXPECT_EQ(src, EncodingUtils::json_unescape(expected)) << pos;
+            }
+        }
+    }
+
+    TEST(EncodingUtils, json_escape_wide_is_fused_utf8)
+    {
+        std::wstring src {L"caf\x00E9 \"\x4E16\"\t\U0001F600\\"};
+        auto         narrow = ConversionUtils::convert_to<wchar_t, char>(src);
+
+        EXPECT_EQ(EncodingUtils::json_escape(narrow), EncodingUtils::json_escape<wchar_t>(src));
+        EXPECT_EQ("caf\xC3\xA9 \\\"\xE4\xB8\x96\\\"\\t\xF0\x9F\x98\x80\\\\", EncodingUtils::json_escape<wchar_t>(src));
+        EXPECT_EQ(EncodingUtils::json_escape(narrow), EncodingUtils::json_escape<char16_t>(u"café \"世\"\t\U0001F600\\"));
+
+        std::string    out {"{\"k\":\""};
+        std::u16string lone {u'a', u'\n', u'\xD800'};
+        EXPECT_THROW(EncodingUtils::json_escape_into<char16_t>(lone, out), std::range_error);
+        EXPECT_EQ("{\"k\":\"a\\n", out);
+    }
+
+    TEST(EncodingUtils, json_unescape)
+    {
+        EXPECT_EQ("say \"hi\"/\\\b\f\n\r\t", EncodingUtils::json_unescape(R"(say \"hi\"\/\\\b\f\n\r\t)"));
+        EXPECT_EQ("caf\xC3\xA9", EncodingUtils::json_unescape(R"(caf\u00e9)"));
+        EXPECT_EQ("\xF0\x9F\x98\x80", EncodingUtils::json_unescape(R"(\uD83D\uDE00)"));
+        EXPECT_EQ(std::string(1, '\0'), EncodingUtils::json_unescape(R"(\u0000)"));
+
+        // Transcoded in the same pass
+        EXPECT_EQ(u"café 世 \U0001F600!", EncodingUtils::json_unescape<char16_t>("caf\xC3\xA9 \\u4e16 \\ud83d\\ude00!"));
+        EXPECT_EQ(L"caf\x00E9 \x4E16 \U0001F600!", EncodingUtils::json_unescape<wchar_t>("caf\\u00E9 \xE4\xB8\x96 \xF0\x9F\x98\x80!"));
+        EXPECT_EQ(U"\U0001F600", EncodingUtils::json_unescape<char32_t>(R"(\ud83d\ude00)"));
+    }
+
+    TEST(EncodingUtils, json_unescape_errors)
+    {
+        for (std::string_view bad : {R"(\x)", R"(\)", R"(\u12)", R"(\u12G4)", R"(\uD83D)", R"(\uD83Dx)", R"(\uD83D\u0041)",
+                                     R"(\uDE00)", "raw \" quote", "raw\ncontrol", "bad \xC3"}) {
+            EXPECT_THROW(EncodingUtils::json_unescape(bad), std::range_error) << bad;
+            EXPECT_THROW(EncodingUtils::json_unescape<wchar_t>(bad), std::range_error) << bad;
+        }
+
+        std::u16string out {u">"};
+        EXPECT_THROW(EncodingUtils::json_unescape_into<char16_t>(R"(ok\n\q)", out), std::range_error);
+        EXPECT_EQ(u">ok\n", out);
+    }
+
+    TEST(EncodingUtils, json_roundtrip_long)
+    {
+        std::u32string src;
+        for (char32_t cp = 0; cp < 0x3000; cp += 7) src += cp;
+        src += U"\U0001F600\U0010FFFF";
+        auto utf8 = ConversionUtils::convert_to<char32_t, char>(src);
+
+        EXPECT_EQ(utf8, EncodingUtils::json_unescape(EncodingUtils::json_escape(utf8)));
+        EXPECT_EQ(src, EncodingUtils::json_unescape<char32_t>(EncodingUtils::json_escape<char32_t>(src)));
+    }
+
+    TEST(EncodingUtils, base64_rfc4648_vectors)
+    {
+        const std::pair<std::string_view, std::string_view> vectors[] {
+                {"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"}, {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"}};
+
+        for (auto [plain, encoded] : vectors) {
+            EXPECT_EQ(encoded, EncodingUtils::base64_encode(plain));
+            EXPECT_EQ(plain, EncodingUtils::base64_decode(encoded));
+            EXPECT_EQ(encoded.size(), EncodingUtils::base64_encoded_length(plain.size()));
+            EXPECT_EQ(plain.size(), EncodingUtils::base64_decoded_length(encoded));
+        }
+    }
+
+    TEST(EncodingUtils, base64_url_and_unpadded)
+    {
+        std::string_view bytes {"\xFB\xFF\xBF\xFE"};
+        EXPECT_EQ("+/+//g==", EncodingUtils::base64_encode(bytes));
+        EXPECT_EQ("-_-__g", EncodingUtils::base64_encode(bytes, base64_variant::url, false));
+        EXPECT_EQ(6u, EncodingUtils::base64_encoded_length(4, false));
+
+        EXPECT_EQ(bytes, EncodingUtils::base64_decode("-_-__g", base64_variant::url, base64_padding::lenient));
+        EXPECT_EQ(bytes, EncodingUtils::base64_decode("-_-__g==", base64_variant::url, base64_padding::lenient));
+        EXPECT_THROW(EncodingUtils::base64_decode("-_-__g", base64_variant::url), std::range_error);
+        // The standard alphabet rejects '-' and '_'
+        EXPECT_THROW(EncodingUtils::base64_decode("-_-__g==", base64_variant::standard), std::range_error);
+    }
+
+    TEST(EncodingUtils, base64_strict_rejects)
+    {
+        uint8_t buffer[16];
+        auto    decode = [&](std::string_view src, base64_padding p = base64_padding::strict) {
+            return EncodingUtils::base64_decode(src, std::span<uint8_t> {buffer}, base64_variant::standard, p);
+        };
+
+        EXPECT_EQ(EncodingUtils::status::ok, decode("Zm9v").status);
+        EXPECT_EQ(EncodingUtils::status::invalid_sequence, decode("Zm9=").status);  // spare bits set
+        EXPECT_EQ(EncodingUtils::status::ok, decode("Zm9=", base64_padding::lenient).status);
+        EXPECT_EQ(EncodingUtils::status::incomplete_sequence, decode("Zm9").status); // missing padding
+        EXPECT_EQ(EncodingUtils::status::incomplete_sequence, decode("Zm9vY", base64_padding::lenient).status);
+        EXPECT_EQ(EncodingUtils::status::invalid_sequence, decode("Zg=").status);
+        EXPECT_EQ(EncodingUtils::status::invalid_sequence, decode("Zg===").status);
+
+        auto rc = decode("Zm9v Zm9");
+        EXPECT_EQ(EncodingUtils::status::invalid_sequence, rc.status);
+        EXPECT_EQ(4u, rc.consumed);
+
+        uint8_t small[2];
+        EXPECT_EQ(EncodingUtils::status::output_too_small,
+                  (EncodingUtils::base64_decode("Zm9v", std::span<uint8_t> {small})).status);
+        char out[3];
+        EXPECT_EQ(EncodingUtils::status::output_too_small,
+                  (EncodingUtils::base64_encode(std::span<const uint8_t> {buffer, 3}, std::span<char> {out})).status);
+    }
+
+    TEST(EncodingUtils, base64_vector_matches_scalar)
+    {
+        // Every length up to several vector blocks, both alphabets, against the scalar kernels
+        std::vector<uint8_t> bytes;
+        for (size_t n = 0; n < 300; n++) {
+            bytes.push_back(static_cast<uint8_t>((n * 167 + 13) & 0xFF));
+            for (auto v : {base64_variant::standard, base64_variant::url}) {
+                std::string fast(EncodingUtils::base64_encoded_length(bytes.size()), '\0');
+                std::string slow(fast.size(), '\0');
+                EncodingUtils::base64_encode(bytes, fast, v, true);
+                EncodingUtils::base64_encode(bytes, slow, v, true, base64::kernels::scalar());
+                ASSERT_EQ(slow, fast) << n;
+
+                std::vector<uint8_t> back(bytes.size());
+                auto                 rc = EncodingUtils::base64_decode(fast, back, v);
+                ASSERT_EQ(EncodingUtils::status::ok, rc.status) << n;
+                ASSERT_EQ(bytes.size(), rc.written);
+                ASSERT_EQ(bytes, back) << n;
+
+                // A bad character anywhere is reported at its offset
+                if (!fast.empty()) {
+                    std::string bad = fast;
+                    bad[n % bad.size()] = '*';
+                    auto err = EncodingUtils::base64_decode(bad, back, v);
+                    EXPECT_EQ(EncodingUtils::status::invalid_sequence, err.status) << n;
+                    EXPECT_EQ(n % bad.size(), err.consumed) << n;
+                }
+            }
+        }
+    }
+} // namespace siddiqsoft
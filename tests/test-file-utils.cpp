@@ -0,0 +1,223 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "../include/siddiqsoft/file-utils.hpp"
+
+using namespace std::string_view_literals;
+
+namespace siddiqsoft
+{
+    namespace
+    {
+        /// @brief A file under the temp directory, removed with the object
+        struct temp_file
+        {
+            std::filesystem::path path;
+
+            explicit temp_file(std::string_view name, std::string_view contents = {})
+                : path(std::filesystem::temp_directory_path() / ("stringhelpers-" + std::string {name}))
+            {
+                std::ofstream(path, std::ios::binary).write(contents.data(), static_cast<std::streamsize>(contents.size()));
+            }
+
+            ~temp_file() { std::filesystem::remove(path); }
+
+            auto read() const -> std::string
+            {
+                std::ifstream in(path, std::ios::binary);
+                return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+            }
+        };
+
+        auto detect(std::string_view bytes) -> encoding_detection
+        {
+            return FileUtils::detect_encoding(std::as_bytes(std::span {bytes.data(), bytes.size()}));
+        }
+
+        /// @brief `s` (ASCII or UTF-16 units) laid out as UTF-16LE or UTF-16BE bytes
+        auto utf16_bytes(std::u16string_view s, bool little) -> std::string
+        {
+            std::string out;
+            for (auto u : s) {
+                const char lo = static_cast<char>(u & 0xFF), hi = static_cast<char>(u >> 8);
+                out += little ? lo : hi;
+                out += little ? hi : lo;
+            }
+            return out;
+        }
+    } // namespace
+
+
+    TEST(FileUtils, detect_bom)
+    {
+        EXPECT_EQ(file_encoding::utf8, detect("\xEF\xBB\xBFhi").encoding);
+        EXPECT_EQ(3u, detect("\xEF\xBB\xBFhi").bom_length);
+        EXPECT_EQ(file_encoding::utf16le, detect("\xFF\xFEh\0"sv).encoding);
+        EXPECT_EQ(file_encoding::utf16be, detect("\xFE\xFF\0h"sv).encoding);
+        EXPECT_EQ(file_encoding::utf32le, detect("\xFF\xFE\0\0h\0\0\0"sv).encoding);
+        EXPECT_EQ(4u, detect("\xFF\xFE\0\0h\0\0\0"sv).bom_length);
+        EXPECT_EQ(file_encoding::utf32be, detect("\0\0\xFE\xFF\0\0\0h"sv).encoding);
+    }
+
+    TEST(FileUtils, detect_heuristic)
+    {
+        EXPECT_EQ(file_encoding::utf8, detect("").encoding);
+        EXPECT_EQ(file_encoding::utf8, detect("plain ascii, comma separated").encoding);
+        EXPECT_EQ(file_encoding::utf8, detect("caf\xC3\xA9").encoding);
+        EXPECT_EQ(file_encoding::cp1252, detect("caf\xE9 \x93quoted\x94").encoding);
+        EXPECT_EQ(file_encoding::utf16le, detect(utf16_bytes(u"name,value\r\n", true)).encoding);
+        EXPECT_EQ(file_encoding::utf16be, detect(utf16_bytes(u"name,value\r\n", false)).encoding);
+        EXPECT_EQ(file_encoding::utf32le, detect("a\0\0\0b\0\0\0"sv).encoding);
+        EXPECT_EQ(file_encoding::utf32be, detect("\0\0\0a\0\0\0b"sv).encoding);
+        EXPECT_EQ(0u, detect(utf16_bytes(u"name,value\r\n", true)).bom_length);
+
+        // A sample cut inside a sequence is still UTF-8
+        std::string big(FileUtils::sample_bytes - 1, 'x');
+        big += "\xC3\xA9";
+        EXPECT_EQ(file_encoding::utf8, detect(big).encoding);
+    }
+
+    TEST(FileUtils, utf16le_csv_to_utf8)
+    {
+        const std::u16string text {u"id,name\r\n1,caf\x00E9\r\n2,\xD83D\xDE00\r\n"};
+        temp_file            src {"utf16le.csv", "\xFF\xFE" + utf16_bytes(text, true)};
+        temp_file            dst {"utf16le.out"};
+
+        auto rc = FileUtils::transcode_file(src.path, dst.path);
+        EXPECT_EQ(file_encoding::utf16le, rc.from);
+        EXPECT_EQ(2u, rc.bom_length);
+        EXPECT_EQ(utf::transcode_status::ok, rc.status);
+        EXPECT_EQ(2 + text.size() * 2, rc.consumed);
+
+        const std::string expected {"id,name\r\n1,caf\xC3\xA9\r\n2,\xF0\x9F\x98\x80\r\n"};
+        EXPECT_EQ(expected, dst.read());
+        EXPECT_EQ(expected.size(), rc.written);
+    }
+
+    TEST(FileUtils, every_encoding_pair)
+    {
+        const std::u16string text {u"a\x00E9\x4E2D\xD83D\xDE00z"};
+        const std::string    utf8 {"a\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80z"};
+        const std::string    utf32le {"a\0\0\0\xE9\0\0\0\x2D\x4E\0\0\x00\xF6\x01\0z\0\0\0"sv};
+        std::string          utf32be {utf32le};
+        for (std::size_t k = 0; k < utf32be.size(); k += 4) std::reverse(utf32be.begin() + k, utf32be.begin() + k + 4);
+
+        const std::pair<file_encoding, std::string> forms[] {{file_encoding::utf8, utf8},
+                                                             {file_encoding::utf16le, utf16_bytes(text, true)},
+                                                             {file_encoding::utf16be, utf16_bytes(text, false)},
+                                                             {file_encoding::utf32le, utf32le},
+                                                             {file_encoding::utf32be, utf32be}};
+        temp_file dst {"pairs.out"};
+        for (const auto& [from, input] : forms) {
+            temp_file src {"pairs.in", input};
+            for (const auto& [to, output] : forms) {
+                // Explicit source encoding; tiny chunks cut the input at every position
+                for (std::size_t chunk : {1u, 3u, 5u, 1024u}) {
+                    auto rc = FileUtils::transcode_file(src.path, dst.path, {.to = to, .from = from, .chunk_bytes = chunk});
+                    EXPECT_EQ(utf::transcode_status::ok, rc.status);
+                    EXPECT_EQ(output, dst.read()) << static_cast<int>(from) << " -> " << static_cast<int>(to) << " / " << chunk;
+                }
+            }
+        }
+    }
+
+    TEST(FileUtils, write_bom_and_cp1252)
+    {
+        temp_file src {"cp1252.txt", "caf\xE9 \x80"};
+        temp_file dst {"cp1252.out"};
+
+        auto rc = FileUtils::transcode_file(src.path, dst.path, {.to = file_encoding::utf16be, .write_bom = true});
+        EXPECT_EQ(file_encoding::cp1252, rc.from);
+        EXPECT_EQ("\xFE\xFF" + utf16_bytes(u"caf\x00E9 \x20AC", false), dst.read());
+        EXPECT_EQ(14u, rc.written);
+
+        // A BOM is dropped (or written) whatever the target
+        temp_file bom {"bom.txt", "\xEF\xBB\xBFok"};
+        FileUtils::transcode_file(bom.path, dst.path);
+        EXPECT_EQ("ok", dst.read());
+        FileUtils::transcode_file(bom.path, dst.path, {.write_bom = true});
+        EXPECT_EQ("\xEF\xBB\xBFok", dst.read());
+
+        temp_file empty {"empty.txt"};
+        rc = FileUtils::transcode_file(empty.path, dst.path);
+        EXPECT_EQ(0u, rc.written);
+        EXPECT_EQ("", dst.read());
+    }
+
+    TEST(FileUtils, malformed_input)
+    {
+        // Forced to UTF-8, where "\xFF" is invalid
+        temp_file src {"bad.txt", "ab\xFF" "cd"};
+        temp_file dst {"bad.out"};
+        const file_transcode_options utf8 {.from = file_encoding::utf8};
+
+        EXPECT_THROW(FileUtils::transcode_file(src.path, dst.path, utf8), std::range_error);
+        EXPECT_EQ("ab", dst.read());
+
+        auto rc = FileUtils::transcode_file<error_policy::report>(src.path, dst.path, utf8);
+        EXPECT_EQ(utf::transcode_status::invalid_sequence, rc.status);
+        EXPECT_EQ(2u, rc.consumed);
+        EXPECT_EQ(2u, rc.written);
+
+        FileUtils::transcode_file<error_policy::replace>(src.path, dst.path, utf8);
+        EXPECT_EQ("ab\xEF\xBF\xBD" "cd", dst.read());
+        FileUtils::transcode_file<error_policy::skip>(src.path, dst.path, utf8);
+        EXPECT_EQ("abcd", dst.read());
+
+        // UTF-16 with an unpaired surrogate, converted in chunks, and cut in the middle of a unit
+        temp_file odd {"odd.txt", "\xFF\xFE" + utf16_bytes(u"ab\xD800" "c", true) + "d"};
+        rc = FileUtils::transcode_file<error_policy::report>(odd.path, dst.path, {.chunk_bytes = 2});
+        EXPECT_EQ(utf::transcode_status::invalid_sequence, rc.status);
+        EXPECT_EQ(6u, rc.consumed);
+        FileUtils::transcode_file<error_policy::replace>(odd.path, dst.path, {.chunk_bytes = 2});
+        EXPECT_EQ("ab\xEF\xBF\xBD" "c\xEF\xBF\xBD", dst.read());
+
+        // An unsupported output encoding is rejected before the destination is truncated
+        const auto before = dst.read();
+        EXPECT_THROW(FileUtils::transcode_file(src.path, dst.path, {.to = file_encoding::cp1252}), std::invalid_argument);
+        EXPECT_EQ(before, dst.read());
+        EXPECT_THROW(FileUtils::transcode_file(src.path.string() + ".missing", dst.path), std::system_error);
+    }
+} // namespace siddiqsoft
@@ -0,0 +1,101 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "gtest/gtest.h"
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "../include/siddiqsoft/format-utils.hpp"
+
+
+namespace siddiqsoft
+{
+    TEST(FormatUtils, ostream)
+    {
+        std::ostringstream os;
+        os << "user=" << as_utf8(L"caf\x00E9") << ' ' << as_utf8(u"\xD83D\xDE00") << ' ' << as_utf8(std::u32string {U"\x4E2D"})
+           << ' ' << as_utf8(u8"ok") << ' ' << as_utf8(std::string_view {"plain"});
+        EXPECT_EQ("user=caf\xC3\xA9 \xF0\x9F\x98\x80 \xE4\xB8\xAD ok plain", os.str());
+    }
+
+    TEST(FormatUtils, ostream_width_and_malformed)
+    {
+        std::ostringstream os;
+        os << '[' << std::setw(6) << as_utf8(u"\x00E9t\x00E9") << ']' << '[' << std::left << std::setw(4) << std::setfill('.')
+           << as_utf8(U"ab") << ']';
+        // The width counts bytes, as for any std::string
+        EXPECT_EQ("[ \xC3\xA9t\xC3\xA9][ab..]", os.str());
+
+        os.str("");
+        os << as_utf8(u"a\xD800" "b") << as_utf8("c\xFF" "d") << as_utf8("e\xE2\x82");
+        EXPECT_EQ("a\xEF\xBF\xBD" "bc\xEF\xBF\xBD" "de\xEF\xBF\xBD", os.str());
+    }
+
+    TEST(FormatUtils, ostream_long_text)
+    {
+        // Longer than the transcoding block, with sequences straddling every block boundary
+        std::u16string src;
+        std::string    expected;
+        for (int k = 0; k < 2000; k++) {
+            src += u"x\x00E9\x4E2D\xD83D\xDE00";
+            expected += "x\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80";
+        }
+
+        std::ostringstream os;
+        os << as_utf8(src);
+        EXPECT_EQ(expected, os.str());
+    }
+
+#if defined(__cpp_lib_format)
+    TEST(FormatUtils, format)
+    {
+        const std::wstring name {L"caf\x00E9"};
+        EXPECT_EQ("user=caf\xC3\xA9 id=7", std::format("user={} id={}", as_utf8(name), 7));
+        EXPECT_EQ("\xF0\x9F\x98\x80", std::format("{}", as_utf8(u"\xD83D\xDE00")));
+        EXPECT_EQ("a\xEF\xBF\xBD", std::format("{}", as_utf8(u"a\xD800")));
+
+        // Specs as for std::string_view; the width counts code points
+        EXPECT_EQ("[caf\xC3\xA9  ]", std::format("[{:<6}]", as_utf8(name)));
+        EXPECT_EQ("[**ab]", std::format("[{:*>4}]", as_utf8(U"ab")));
+        EXPECT_EQ("[ca]", std::format("[{:.2}]", as_utf8(name)));
+
+        std::string out;
+        std::format_to(std::back_inserter(out), "{}|{}", as_utf8(L"x"), as_utf8(u8"y"));
+        EXPECT_EQ("x|y", out);
+    }
+#endif
+} // namespace siddiqsoft
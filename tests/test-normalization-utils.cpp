@@ -0,0 +1,143 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include "gtest/gtest.h"
+#include <string>
+#include <string_view>
+
+#include "../include/siddiqsoft/conversion-utils.hpp"
+#include "../include/siddiqsoft/normalization-utils.hpp"
+
+
+namespace siddiqsoft
+{
+    TEST(NormalizationUtils, nfc_and_nfd)
+    {
+        // "café" precomposed and decomposed
+        const std::string composed {"caf\xC3\xA9"}, decomposed {"cafe\xCC\x81"};
+
+        EXPECT_EQ(composed, NormalizationUtils::normalize(decomposed));
+        EXPECT_EQ(composed, NormalizationUtils::normalize(composed));
+        EXPECT_EQ(decomposed, NormalizationUtils::normalize(composed, normalization_form::nfd));
+        EXPECT_EQ(decomposed, NormalizationUtils::normalize(decomposed, normalization_form::nfd));
+        EXPECT_EQ("", NormalizationUtils::normalize(""));
+
+        // Singletons and composition exclusions: Angstrom and Ohm signs, U+0344
+        EXPECT_EQ(U"\x00C5\x03A9\x0308\x0301", NormalizationUtils::normalize<char32_t>(U"\x212B\x2126\x0344"));
+        EXPECT_EQ(U"A\x030A\x03A9\x0308\x0301", NormalizationUtils::normalize<char32_t>(U"\x212B\x2126\x0344", normalization_form::nfd));
+    }
+
+    TEST(NormalizationUtils, canonical_ordering)
+    {
+        // Dot below (220) sorts before dot above (230); both compose onto s
+        EXPECT_EQ(u"\x1E69", NormalizationUtils::normalize<char16_t>(u"s\x0307\x0323"));
+        EXPECT_EQ(u"s\x0323\x0307", NormalizationUtils::normalize<char16_t>(u"\x1E69", normalization_form::nfd));
+
+        // A mark of the same class blocks the second one
+        EXPECT_EQ(u"\x00E0\x0301", NormalizationUtils::normalize<char16_t>(u"a\x0300\x0301"));
+        EXPECT_EQ(u"\x00E1\x0300", NormalizationUtils::normalize<char16_t>(u"a\x0301\x0300"));
+    }
+
+    TEST(NormalizationUtils, hangul)
+    {
+        // Jamo L V T compose to a syllable and back
+        EXPECT_EQ(L"\xD55C", NormalizationUtils::normalize<wchar_t>(L"\x1112\x1161\x11AB"));
+        EXPECT_EQ(L"\x1112\x1161\x11AB", NormalizationUtils::normalize<wchar_t>(L"\xD55C", normalization_form::nfd));
+        EXPECT_EQ(L"\xD55C", NormalizationUtils::normalize<wchar_t>(L"\xD558\x11AB")); // LV + T
+        EXPECT_EQ(L"\xD55C\x11AB", NormalizationUtils::normalize<wchar_t>(L"\xD55C\x11AB")); // LVT + T does not compose
+        EXPECT_TRUE(NormalizationUtils::is_normalized<wchar_t>(L"\xD55C\xAE00"));
+        EXPECT_FALSE(NormalizationUtils::is_normalized<wchar_t>(L"\x1112\x1161"));
+    }
+
+    TEST(NormalizationUtils, is_normalized)
+    {
+        EXPECT_TRUE(NormalizationUtils::is_normalized("Content-Type"));
+        EXPECT_TRUE(NormalizationUtils::is_normalized("caf\xC3\xA9"));
+        EXPECT_FALSE(NormalizationUtils::is_normalized("caf\xC3\xA9", normalization_form::nfd));
+        EXPECT_FALSE(NormalizationUtils::is_normalized("cafe\xCC\x81"));
+        EXPECT_TRUE(NormalizationUtils::is_normalized("cafe\xCC\x81", normalization_form::nfd));
+
+        // Quick check "maybe": a combining mark that does not compose with what precedes it
+        EXPECT_TRUE(NormalizationUtils::is_normalized<char16_t>(u"x\x0301"));
+        EXPECT_FALSE(NormalizationUtils::is_normalized<char16_t>(u"e\x0301"));
+    }
+
+    TEST(NormalizationUtils, normalized_returns_input_without_copying)
+    {
+        std::string      storage;
+        std::string_view src {"x-ms-client-request-id: caf\xC3\xA9 \xE4\xB8\x96"};
+
+        auto view = NormalizationUtils::normalized(src, storage);
+        EXPECT_EQ(src.data(), view.data());
+        EXPECT_TRUE(storage.empty());
+
+        std::string_view decomposed {"x-ms-client-request-id: cafe\xCC\x81 \xE4\xB8\x96"};
+        view = NormalizationUtils::normalized(decomposed, storage);
+        EXPECT_EQ(src, view);
+        EXPECT_EQ(storage.data(), view.data());
+    }
+
+    TEST(NormalizationUtils, every_offset)
+    {
+        // A mark moved through several vector blocks in each encoding
+        for (size_t pos = 0; pos < 100; pos++) {
+            std::u32string src(100, U'e'), nfc(100, U'e');
+            src.insert(pos + 1, 1, U'\x0301');
+            nfc[pos] = U'\x00E9';
+
+            EXPECT_EQ(nfc, NormalizationUtils::normalize<char32_t>(src)) << pos;
+            EXPECT_EQ(src, NormalizationUtils::normalize<char32_t>(nfc, normalization_form::nfd)) << pos;
+
+            const auto utf8 = ConversionUtils::convert_to<char32_t, char>(src);
+            const auto nfc8 = ConversionUtils::convert_to<char32_t, char>(nfc);
+            EXPECT_EQ(nfc8, NormalizationUtils::normalize(utf8)) << pos;
+            EXPECT_FALSE(NormalizationUtils::is_normalized(utf8)) << pos;
+
+            const auto wide    = ConversionUtils::convert_to<char32_t, wchar_t>(nfc);
+            const auto nfdWide = ConversionUtils::convert_to<char32_t, wchar_t>(src);
+            EXPECT_TRUE(NormalizationUtils::is_normalized<wchar_t>(wide)) << pos;
+            EXPECT_EQ(nfdWide, NormalizationUtils::normalize<wchar_t>(wide, normalization_form::nfd)) << pos;
+        }
+    }
+
+    TEST(NormalizationUtils, invalid_input_throws)
+    {
+        EXPECT_THROW(NormalizationUtils::normalize("bad \x80"), std::range_error);
+        EXPECT_THROW(NormalizationUtils::is_normalized("bad \xC3"), std::range_error);
+        EXPECT_THROW(NormalizationUtils::normalize<char16_t>(std::u16string {u'a', u'\xDC00'}), std::range_error);
+        EXPECT_THROW(NormalizationUtils::normalize<char32_t>(std::u32string {U'a', static_cast<char32_t>(0x110000)}), std::range_error);
+    }
+} // namespace siddiqsoft
@@ -0,0 +1,118 @@
+/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../include/siddiqsoft/transcode-views.hpp"
+
+
+namespace siddiqsoft
+{
+    // "A é 世 😀 z" in each encoding
+    static const std::string    kMixed8 {"A\xC3\xA9\xE4\xB8\x96\xF0\x9F\x98\x80 z"};
+    static const std::u16string kMixed16 {u"Aé世\U0001F600 z"};
+    static const std::u32string kMixed32 {U"Aé世\U0001F600 z"};
+
+    static_assert(std::ranges::view<decltype(std::string_view {} | views::transcode<char, wchar_t>)>);
+    static_assert(std::ranges::forward_range<decltype(std::u16string_view {} | views::utf16_to_utf8)>);
+    static_assert(std::ranges::borrowed_range<decltype(std::string_view {} | views::utf8_to_utf32)>);
+    static_assert(std::ranges::borrowed_range<transcode_view<std::u16string_view, char>>);
+    static_assert(!std::ranges::borrowed_range<decltype(std::string {} | views::utf8_to_utf32)>);
+
+    TEST(TranscodeViews, matches_convert_to)
+    {
+        auto u32 = kMixed8 | views::utf8_to_utf32;
+        EXPECT_TRUE(std::ranges::equal(u32, kMixed32));
+
+        auto u16 = kMixed32 | views::utf32_to_utf16;
+        EXPECT_TRUE(std::ranges::equal(u16, kMixed16));
+
+        auto u8 = kMixed16 | views::transcode<char16_t, char>;
+        EXPECT_TRUE(std::ranges::equal(u8, kMixed8));
+
+        auto wide = ConversionUtils::convert_to<char, wchar_t>(kMixed8);
+        EXPECT_TRUE(std::ranges::equal(kMixed8 | views::transcode<char, wchar_t>, wide));
+    }
+
+    TEST(TranscodeViews, composes_with_algorithms)
+    {
+        std::string_view header {"x-ms-version: 2024\xE2\x80\x93" "01"};
+        auto             wide = header | views::transcode<char, wchar_t>;
+
+        auto colon = std::ranges::find(wide, L':');
+        ASSERT_NE(colon, wide.end());
+        EXPECT_EQ(header.data() + 12, colon.base());
+
+        std::wstring name;
+        std::ranges::copy(wide | std::views::take_while([](wchar_t c) { return c != L':'; }), std::back_inserter(name));
+        EXPECT_EQ(std::wstring(L"x-ms-version"), name);
+
+        // Only the first two code points are decoded
+        auto prefix = kMixed8 | views::utf8_to_utf16 | std::views::take(2);
+        EXPECT_TRUE(std::ranges::equal(prefix, std::u16string_view {u"Aé"}));
+
+#if defined(SIDDIQSOFT_STRINGHELPERS_RANGE_ADAPTOR_CLOSURE)
+        // A pipeline composed before it meets a range
+        auto firstTwo = views::utf8_to_utf16 | std::views::take(2);
+        EXPECT_TRUE(std::ranges::equal(kMixed8 | firstTwo, std::u16string_view {u"Aé"}));
+#endif
+    }
+
+    TEST(TranscodeViews, rvalue_and_vector_sources)
+    {
+        auto owned = std::string {"\xF0\x9F\x98\x80!"} | views::utf8_to_utf16;
+        EXPECT_EQ(3, std::ranges::distance(owned));
+
+        std::vector<char32_t> cps {U'a', U'\x1F600'};
+        EXPECT_EQ(5, std::ranges::distance(cps | views::utf32_to_utf8));
+        EXPECT_TRUE((std::string_view {} | views::utf8_to_utf32).empty());
+    }
+
+    TEST(TranscodeViews, malformed_input_reads_as_replacement)
+    {
+        std::string_view bad {"a\xC0\x80" "b\xE4\xB8"};
+        EXPECT_TRUE(std::ranges::equal(bad | views::utf8_to_utf32, std::u32string_view {U"a��b�"}));
+
+        std::u16string lone {u'\xDC00', u'x'};
+        EXPECT_TRUE(std::ranges::equal(lone | views::utf16_to_utf8, std::string_view {"\xEF\xBF\xBDx"}));
+    }
+} // namespace siddiqsoft
@@ -35,6 +35,11 @@
 
 #include "gtest/gtest.h"
 #include <iostream>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <typeinfo>
+#include <vector>
 
 
 #include "../include/siddiqsoft/conversion-utils.hpp"
@@ -467,6 +472,772 @@ namespace siddiqsoft
     }
 
 
+    // =========================================================================
+    // Malformed input is rejected with std::range_error
+    // =========================================================================
+
+    TEST(ConversionUtils, invalid_utf8_throws)
+    {
+        // Overlong NUL, encoded surrogate, beyond U+10FFFF, bad continuation, truncated
+        for (const auto& src : {std::string {"\xC0\x80"},
+                                      std::string {"\xED\xA0\x80"},
+                                      std::string {"\xF4\x90\x80\x80"},
+                                      std::string {"\xE4\x41\x41"},
+                                      std::string {"ab\xE4\xB8"}})
+        {
+            EXPECT_THROW((ConversionUtils::convert_to<char, wchar_t>(src)), std::range_error);
+        }
+    }
+
+#if !defined(WIN32)
+    TEST(ConversionUtils, invalid_wide_throws)
+    {
+        EXPECT_THROW((ConversionUtils::convert_to<wchar_t, char>(std::wstring(1, static_cast<wchar_t>(0x110000)))),
+                     std::range_error);
+        EXPECT_THROW((ConversionUtils::convert_to<wchar_t, char>(std::wstring(1, static_cast<wchar_t>(0xD800)))),
+                     std::range_error);
+    }
+#endif
+
+
+    // =========================================================================
+    // Multi-byte sequences at every offset around the vector block sizes
+    // =========================================================================
+
+    TEST(ConversionUtils, multibyte_at_every_offset_roundtrip)
+    {
+        for (size_t len = 0; len < 80; len++) {
+            for (size_t pos = 0; pos <= len; pos++) {
+                std::string src(len, 'a');
+                src.insert(pos, "\xE4\xB8\x96");
+                auto wide = ConversionUtils::convert_to<char, wchar_t>(src);
+                ASSERT_EQ(len + 1, wide.size());
+                EXPECT_EQ(static_cast<wchar_t>(0x4E16), wide[pos]);
+                EXPECT_EQ(src, (ConversionUtils::convert_to<wchar_t, char>(wide)));
+            }
+        }
+    }
+
+
+    // =========================================================================
+    // convert_into / required_length: caller-owned buffers
+    // =========================================================================
+
+    TEST(ConversionUtils, required_length_matches_convert_to)
+    {
+        std::string  src {"A\xC3\xA9\xE4\xB8\x96\xF0\x9F\x98\x80"};
+        std::wstring wide = ConversionUtils::convert_to<char, wchar_t>(src);
+
+        EXPECT_EQ(wide.size(), (ConversionUtils::required_length<char, wchar_t>(src)));
+        EXPECT_EQ(src.size(), (ConversionUtils::required_length<wchar_t, char>(wide)));
+        EXPECT_EQ(src.size(), (ConversionUtils::required_length<char, char>(src)));
+        EXPECT_EQ(0u, (ConversionUtils::required_length<char, wchar_t>("")));
+    }
+
+    TEST(ConversionUtils, convert_into_span)
+    {
+        std::string          src {"Hello, \xE4\xB8\x96\xE7\x95\x8C"};
+        std::vector<wchar_t> buffer(ConversionUtils::required_length<char, wchar_t>(src));
+
+        auto rc = ConversionUtils::convert_into<char, wchar_t>(src, buffer);
+        EXPECT_EQ(ConversionUtils::status::ok, rc.status);
+        EXPECT_EQ(src.size(), rc.consumed);
+        ASSERT_EQ(buffer.size(), rc.written);
+        EXPECT_EQ((ConversionUtils::convert_to<char, wchar_t>(src)), std::wstring(buffer.data(), rc.written));
+
+        std::vector<char> narrow(ConversionUtils::required_length<wchar_t, char>({buffer.data(), buffer.size()}));
+        rc = ConversionUtils::convert_into<wchar_t, char>({buffer.data(), buffer.size()}, narrow);
+        EXPECT_EQ(ConversionUtils::status::ok, rc.status);
+        EXPECT_EQ(src, std::string(narrow.data(), rc.written));
+    }
+
+    TEST(ConversionUtils, convert_into_span_too_small)
+    {
+        std::string src {"abc\xE4\xB8\x96"};
+        wchar_t     buffer[3] {};
+
+        auto rc = ConversionUtils::convert_into<char, wchar_t>(src, std::span<wchar_t> {buffer});
+        EXPECT_EQ(ConversionUtils::status::output_too_small, rc.status);
+        EXPECT_EQ(3u, rc.written);
+        EXPECT_EQ(3u, rc.consumed);
+
+        std::wstring wsrc {L"ab\x4E16"};
+        char         narrow[4] {};
+        rc = ConversionUtils::convert_into<wchar_t, char>(wsrc, std::span<char> {narrow});
+        EXPECT_EQ(ConversionUtils::status::output_too_small, rc.status);
+        EXPECT_EQ(2u, rc.written);
+        EXPECT_EQ(2u, rc.consumed);
+    }
+
+    TEST(ConversionUtils, convert_into_reports_error_offset)
+    {
+        std::string          src {"abc\xC0\x80" "def"};
+        std::vector<wchar_t> buffer(src.size());
+
+        auto rc = ConversionUtils::convert_into<char, wchar_t>(src, buffer);
+        EXPECT_EQ(ConversionUtils::status::invalid_sequence, rc.status);
+        EXPECT_EQ(3u, rc.consumed);
+        EXPECT_EQ(3u, rc.written);
+    }
+
+    TEST(ConversionUtils, convert_into_appends_and_reuses_capacity)
+    {
+        std::wstring dst;
+        dst.reserve(64);
+        const auto* storage = dst.data();
+
+        ConversionUtils::convert_into<char, wchar_t>("Content-", dst);
+        auto rc = ConversionUtils::convert_into<char, wchar_t>("Type: \xC3\xA9", dst);
+        EXPECT_EQ(ConversionUtils::status::ok, rc.status);
+        EXPECT_EQ(7u, rc.written);
+        EXPECT_EQ(std::wstring(L"Content-Type: \x00E9"), dst);
+        EXPECT_EQ(storage, dst.data());
+    }
+
+
+    // =========================================================================
+    // string_view and contiguous range sources
+    // =========================================================================
+
+    TEST(ConversionUtils, string_view_source)
+    {
+        const char*      packet {"GET /\xE4\xB8\x96 HTTP/1.1\r\n"};
+        std::string_view path {packet + 4, 4};
+
+        EXPECT_EQ(std::wstring(L"/\x4E16"), (ConversionUtils::convert_to<char, wchar_t>(path)));
+        EXPECT_EQ(std::string("GET"), (ConversionUtils::convert_to<char, char>(std::string_view {packet, 3})));
+        EXPECT_EQ(std::wstring(L"abc"), (ConversionUtils::convert_to<char, wchar_t>("abc")));
+    }
+
+    TEST(ConversionUtils, contiguous_range_source)
+    {
+        std::vector<char>    bytes {'B', 'a', 'n', 'c', '\xC3', '\xA9'};
+        std::vector<wchar_t> wide {L'B', L'a', L'n', L'c', L'\x00E9'};
+
+        EXPECT_EQ(std::wstring(L"Banc\x00E9"), (ConversionUtils::convert_to<char, wchar_t>(bytes)));
+        EXPECT_EQ(std::string("Banc\xC3\xA9"), (ConversionUtils::convert_to<wchar_t, char>(wide)));
+        EXPECT_EQ(std::wstring(L"Banc"), (ConversionUtils::convert_to<char, wchar_t>(std::span<const char> {bytes.data(), 4})));
+        EXPECT_EQ(std::wstring(L"Banc\x00E9"), ConversionUtils::convert_to(bytes));
+    }
+
+    TEST(ConversionUtils, identity_rvalue_is_moved)
+    {
+        std::string src(1000, 'x');
+        const auto* storage = src.data();
+
+        auto result = ConversionUtils::convert_to<char, char>(std::move(src));
+        EXPECT_EQ(storage, result.data());
+        EXPECT_EQ(1000u, result.size());
+
+        std::wstring wsrc(1000, L'y');
+        const auto*  wstorage = wsrc.data();
+        auto         wresult  = ConversionUtils::convert_to<wchar_t, wchar_t>(std::move(wsrc));
+        EXPECT_EQ(wstorage, wresult.data());
+    }
+
+    TEST(ConversionUtils, rvalue_source_is_converted)
+    {
+        EXPECT_EQ(std::wstring(L"\x00E9"), (ConversionUtils::convert_to<char, wchar_t>(std::string {"\xC3\xA9"})));
+    }
+
+
+    // =========================================================================
+    // Stream: chunked input with carry-over of partial sequences
+    // =========================================================================
+
+    TEST(ConversionUtils, stream_split_at_every_byte)
+    {
+        std::string  src {"A\xC3\xA9\xE4\xB8\x96\xF0\x9F\x98\x80Z"};
+        std::wstring expected = ConversionUtils::convert_to<char, wchar_t>(src);
+
+        for (size_t split = 0; split <= src.size(); split++) {
+            ConversionUtils::Stream<char, wchar_t> stream;
+            std::wstring                           out;
+            EXPECT_EQ(ConversionUtils::status::ok, stream.feed(std::string_view {src}.substr(0, split), out).status);
+            EXPECT_EQ(ConversionUtils::status::ok, stream.feed(std::string_view {src}.substr(split), out).status);
+            EXPECT_EQ(ConversionUtils::status::ok, stream.finish().status);
+            EXPECT_EQ(expected, out);
+        }
+    }
+
+    TEST(ConversionUtils, stream_one_byte_at_a_time)
+    {
+        std::string                            src {"Hello, \xE4\xB8\x96\xE7\x95\x8C \xF0\x9F\x98\x80"};
+        ConversionUtils::Stream<char, wchar_t> stream;
+        std::wstring                           out;
+
+        for (char c : src) out += stream.feed(std::string_view {&c, 1});
+        EXPECT_EQ((ConversionUtils::convert_to<char, wchar_t>(src)), out);
+        EXPECT_EQ(0u, stream.pending_units());
+    }
+
+    TEST(ConversionUtils, stream_finish_reports_truncation)
+    {
+        ConversionUtils::Stream<char, wchar_t> stream;
+        std::wstring                           out;
+
+        auto rc = stream.feed("ab\xF0\x9F", out);
+        EXPECT_EQ(ConversionUtils::status::ok, rc.status);
+        EXPECT_EQ(std::wstring(L"ab"), out);
+        EXPECT_EQ(2u, stream.pending_units());
+
+        rc = stream.finish();
+        EXPECT_EQ(ConversionUtils::status::incomplete_sequence, rc.status);
+        EXPECT_EQ(2u, rc.consumed);
+        EXPECT_EQ(ConversionUtils::status::ok, stream.finish().status);
+    }
+
+    TEST(ConversionUtils, stream_interrupted_sequence_is_invalid)
+    {
+        ConversionUtils::Stream<char, wchar_t> stream;
+        std::wstring                           out;
+
+        EXPECT_EQ(ConversionUtils::status::ok, stream.feed("x\xE4", out).status);
+        EXPECT_EQ(ConversionUtils::status::invalid_sequence, stream.feed("A", out).status);
+        EXPECT_THROW(stream.feed("\xC0\x80"), std::range_error);
+    }
+
+    TEST(ConversionUtils, stream_wide_to_narrow)
+    {
+        std::wstring                           src {L"Banc\x00E9 \x4E16\x754C"};
+        ConversionUtils::Stream<wchar_t, char> stream;
+        std::string                            out;
+
+        for (size_t i = 0; i < src.size(); i += 3) stream.feed(std::wstring_view {src}.substr(i, 3), out);
+        EXPECT_EQ(ConversionUtils::status::ok, stream.finish().status);
+        EXPECT_EQ((ConversionUtils::convert_to<wchar_t, char>(src)), out);
+    }
+
+
+    // =========================================================================
+    // char8_t, char16_t and char32_t pairs
+    // =========================================================================
+
+    // The same text (1, 2, 3 and 4 byte sequences) in every representation
+    static const std::string    kMixed8 {"A\xC3\xA9\xE4\xB8\x96\xF0\x9F\x98\x80 z"};
+    static const std::u8string  kMixedU8 {u8"A\u00E9\u4E16\U0001F600 z"};
+    static const std::u16string kMixed16 {u"A\u00E9\u4E16\U0001F600 z"};
+    static const std::u32string kMixed32 {U"A\u00E9\u4E16\U0001F600 z"};
+    static const std::wstring   kMixedW {L"A\u00E9\u4E16\U0001F600 z"};
+
+    template <typename C>
+    static const std::basic_string<C>& mixed_sample()
+    {
+        if constexpr (std::is_same_v<C, char>) return kMixed8;
+        else if constexpr (std::is_same_v<C, char8_t>) return kMixedU8;
+        else if constexpr (std::is_same_v<C, char16_t>) return kMixed16;
+        else if constexpr (std::is_same_v<C, char32_t>) return kMixed32;
+        else return kMixedW;
+    }
+
+    template <typename S, typename... Ds>
+    static void expect_converts_to_all()
+    {
+        (
+                [] {
+                    auto result = ConversionUtils::convert_to<S, Ds>(mixed_sample<S>());
+                    // EXPECT_TRUE: gtest only links a char8_t printer when the library itself is built as C++20
+                    EXPECT_TRUE(mixed_sample<Ds>() == result) << typeid(S).name() << " -> " << typeid(Ds).name();
+                    EXPECT_EQ(result.size(), (ConversionUtils::required_length<S, Ds>(mixed_sample<S>())));
+                }(),
+                ...);
+    }
+
+    TEST(ConversionUtils, all_pairs)
+    {
+        expect_converts_to_all<char, char, char8_t, char16_t, char32_t, wchar_t>();
+        expect_converts_to_all<char8_t, char, char8_t, char16_t, char32_t, wchar_t>();
+        expect_converts_to_all<char16_t, char, char8_t, char16_t, char32_t, wchar_t>();
+        expect_converts_to_all<char32_t, char, char8_t, char16_t, char32_t, wchar_t>();
+        expect_converts_to_all<wchar_t, char, char8_t, char16_t, char32_t, wchar_t>();
+    }
+
+    TEST(ConversionUtils, wchar_width_matches_platform)
+    {
+        auto wide = ConversionUtils::convert_to<char, wchar_t>(std::string {"\xF0\x9F\x98\x80"});
+        EXPECT_EQ(sizeof(wchar_t) == 2 ? 2u : 1u, wide.size());
+    }
+
+    TEST(ConversionUtils, utf16_multibyte_at_every_offset_roundtrip)
+    {
+        for (size_t len = 0; len < 80; len++) {
+            for (size_t pos = 0; pos <= len; pos += 7) {
+                std::string src(len, 'a');
+                src.insert(pos, "\xF0\x9F\x98\x80");
+                auto u16 = ConversionUtils::convert_to<char, char16_t>(src);
+                ASSERT_EQ(len + 2, u16.size());
+                EXPECT_EQ(u'\xD83D', u16[pos]);
+                EXPECT_EQ(src, (ConversionUtils::convert_to<char16_t, char>(u16)));
+            }
+        }
+    }
+
+    TEST(ConversionUtils, invalid_utf16_throws)
+    {
+        // Lone low surrogate, high surrogate followed by a non-surrogate, truncated pair
+        for (const auto& src : {std::u16string(1, u'\xDC00'), std::u16string {u'\xD83D', u'a'}, std::u16string(1, u'\xD83D')}) {
+            EXPECT_THROW((ConversionUtils::convert_to<char16_t, char>(src)), std::range_error);
+            EXPECT_THROW((ConversionUtils::convert_to<char16_t, char32_t>(src)), std::range_error);
+        }
+        EXPECT_THROW((ConversionUtils::convert_to<char32_t, char16_t>(std::u32string(1, U'\xD800'))), std::range_error);
+    }
+
+    TEST(ConversionUtils, stream_utf16_carries_surrogate_pair)
+    {
+        ConversionUtils::Stream<char16_t, char> stream;
+        std::string                             out;
+
+        EXPECT_EQ(ConversionUtils::status::ok, stream.feed(std::u16string_view {kMixed16}.substr(0, 4), out).status);
+        EXPECT_EQ(1u, stream.pending_units());
+        EXPECT_EQ(ConversionUtils::status::ok, stream.feed(std::u16string_view {kMixed16}.substr(4), out).status);
+        EXPECT_EQ(ConversionUtils::status::ok, stream.finish().status);
+        EXPECT_EQ(kMixed8, out);
+    }
+
+
+    // =========================================================================
+    // Validation without conversion
+    // =========================================================================
+
+    TEST(ConversionUtils, validate_utf8_valid)
+    {
+        EXPECT_TRUE(ConversionUtils::is_valid_utf8(""));
+        EXPECT_TRUE(ConversionUtils::is_valid_utf8(kMixed8));
+        EXPECT_TRUE(ConversionUtils::is_valid_utf8(kMixedU8));
+        EXPECT_TRUE(ConversionUtils::is_valid_utf8(std::string(10000, 'x')));
+
+        auto rc = ConversionUtils::validate<char>(kMixed8);
+        EXPECT_EQ(ConversionUtils::status::ok, rc.status);
+        EXPECT_EQ(kMixed8.size(), rc.consumed);
+    }
+
+    TEST(ConversionUtils, validate_utf8_reports_offset)
+    {
+        // Each malformed sequence at every offset around the vector block sizes
+        for (const std::string bad : {"\xC0\x80", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xE4\x41", "\x80", "\xFF"}) {
+            for (size_t pos = 0; pos < 70; pos++) {
+                std::string src(pos, 'a');
+                src += bad;
+                src += std::string(40, 'b');
+                auto rc = ConversionUtils::validate<char>(src);
+                EXPECT_EQ(ConversionUtils::status::invalid_sequence, rc.status);
+                EXPECT_EQ(pos, rc.consumed);
+            }
+        }
+    }
+
+    TEST(ConversionUtils, validate_utf8_long_multibyte)
+    {
+        std::string src;
+        for (int i = 0; i < 100; i++) src += kMixed8;
+        EXPECT_TRUE(ConversionUtils::is_valid_utf8(src));
+
+        // Replace the 'A' that starts the 50th copy with a stray continuation byte
+        src[50 * kMixed8.size()] = '\x80';
+        auto rc = ConversionUtils::validate<char>(src);
+        EXPECT_EQ(ConversionUtils::status::invalid_sequence, rc.status);
+        EXPECT_EQ(50 * kMixed8.size(), rc.consumed);
+        EXPECT_THROW((ConversionUtils::convert_to<char, wchar_t>(src)), std::range_error);
+
+        std::string truncated = src.substr(0, 100 * kMixed8.size() / 2 - 2);
+        truncated += "\xF0\x9F";
+        rc = ConversionUtils::validate<char>(truncated);
+        EXPECT_EQ(ConversionUtils::status::incomplete_sequence, rc.status);
+        EXPECT_EQ(truncated.size() - 2, rc.consumed);
+    }
+
+    TEST(ConversionUtils, validate_utf16_reports_offset)
+    {
+        EXPECT_TRUE(ConversionUtils::is_valid_utf16(kMixed16));
+
+        std::u16string src(37, u'a');
+        src += u'\xDC00';
+        src += std::u16string(20, u'b');
+        EXPECT_FALSE(ConversionUtils::is_valid_utf16(src));
+        EXPECT_EQ(37u, ConversionUtils::validate<char16_t>(src).consumed);
+
+        auto rc = ConversionUtils::validate<char16_t>(std::u16string(9, u'a') + u'\xD83D');
+        EXPECT_EQ(ConversionUtils::status::incomplete_sequence, rc.status);
+        EXPECT_EQ(9u, rc.consumed);
+    }
+
+
+    // =========================================================================
+    // Error policies
+    // =========================================================================
+
+    TEST(ConversionUtils, policy_replace)
+    {
+        std::string src {"a\xC0\x80" "b\xE4\x41\xF0\x9F\x98"};
+
+        auto wide = ConversionUtils::convert_to<char, wchar_t, error_policy::replace>(src);
+        EXPECT_EQ(std::wstring(L"a\xFFFD\xFFFD" L"b\xFFFD" L"A\xFFFD"), wide);
+
+        auto u16 = ConversionUtils::convert_to<char, char16_t, error_policy::replace>(std::string_view {src});
+        EXPECT_EQ(std::u16string(u"a\xFFFD\xFFFD" u"b\xFFFD" u"A\xFFFD"), u16);
+    }
+
+    TEST(ConversionUtils, policy_replace_grows_output)
+    {
+        // Each lone surrogate counts two bytes in the length estimate but becomes EF BF BD
+        std::u16string src {u'\xDC00', u'x', u'\xDC01', u'\xDC02', u'\xD800'};
+        auto           narrow = ConversionUtils::convert_to<char16_t, char, error_policy::replace>(src);
+        EXPECT_EQ(std::string("\xEF\xBF\xBD" "x\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD"), narrow);
+    }
+
+    TEST(ConversionUtils, policy_skip)
+    {
+        std::string src {"a\xC0\x80" "b\xE4\x41\xF0\x9F\x98"};
+        EXPECT_EQ(std::wstring(L"abA"), (ConversionUtils::convert_to<char, wchar_t, error_policy::skip>(src)));
+        EXPECT_EQ(std::string("ab"),
+                  (ConversionUtils::convert_to<char32_t, char, error_policy::skip>(std::u32string {U'a', U'\xD800', U'b'})));
+    }
+
+    TEST(ConversionUtils, policy_report)
+    {
+        auto good = ConversionUtils::convert_to<char, wchar_t, error_policy::report>(std::string {"ok \xC3\xA9"});
+        ASSERT_TRUE(good.has_value());
+        EXPECT_EQ(std::wstring(L"ok \x00E9"), *good);
+
+        auto bad = ConversionUtils::convert_to<char, wchar_t, error_policy::report>(std::string {"abc\xED\xA0\x80"});
+        ASSERT_FALSE(bad);
+        EXPECT_EQ(ConversionUtils::status::invalid_sequence, bad.error().status);
+        EXPECT_EQ(3u, bad.error().consumed);
+        EXPECT_THROW(bad.value(), std::range_error);
+
+        auto cut = ConversionUtils::convert_to<char, char16_t, error_policy::report>(std::string {"ab\xE4\xB8"});
+        EXPECT_EQ(ConversionUtils::status::incomplete_sequence, cut.error().status);
+    }
+
+    TEST(ConversionUtils, policy_convert_into)
+    {
+        std::string src {"x\xFFy"};
+        wchar_t     buffer[8] {};
+
+        auto rc = ConversionUtils::convert_into<char, wchar_t, error_policy::replace>(src, std::span<wchar_t> {buffer});
+        EXPECT_EQ(ConversionUtils::status::ok, rc.status);
+        EXPECT_EQ(std::wstring(L"x\xFFFDy"), std::wstring(buffer, rc.written));
+
+        std::wstring appended {L">"};
+        EXPECT_THROW((ConversionUtils::convert_into<char, wchar_t, error_policy::throw_error>(src, appended)), std::range_error);
+        EXPECT_EQ(std::wstring(L">x"), appended);
+    }
+
+    TEST(ConversionUtils, policy_same_encoding)
+    {
+        // Pairs that share an encoding are copied, but only once the input validates
+        EXPECT_THROW((ConversionUtils::convert_to<char, char8_t, error_policy::throw_error>("\xFF")), std::range_error);
+        EXPECT_THROW((ConversionUtils::convert_to<char, char, error_policy::throw_error>("a\xC0\x80")), std::range_error);
+        EXPECT_THROW((ConversionUtils::convert_to<char, char>(std::string {"\xED\xA0\x80"})), std::range_error);
+
+        EXPECT_TRUE(std::u8string(u8"a\uFFFDb") == (ConversionUtils::convert_to<char, char8_t, error_policy::replace>("a\xFF" "b")));
+        EXPECT_TRUE(std::u8string(u8"ab") == (ConversionUtils::convert_to<char, char8_t, error_policy::skip>("a\xFF" "b")));
+        EXPECT_EQ(std::u16string(u"x\xFFFD"), (ConversionUtils::convert_to<char16_t, char16_t, error_policy::replace>(u"x\xDC00")));
+
+        auto bad = ConversionUtils::convert_to<char8_t, char, error_policy::report>(u8"ok" "\xE4\xB8");
+        ASSERT_FALSE(bad);
+        EXPECT_EQ(ConversionUtils::status::incomplete_sequence, bad.error().status);
+        EXPECT_EQ(2u, bad.error().consumed);
+
+        // A buffer too small for the next sequence stops before it
+        char8_t buffer[2] {};
+        auto    rc = ConversionUtils::convert_into<char, char8_t>("a\xC3\xA9", std::span<char8_t> {buffer});
+        EXPECT_EQ(ConversionUtils::status::output_too_small, rc.status);
+        EXPECT_EQ(1u, rc.written);
+
+        // The stream holds back a split sequence instead of passing half of it through
+        ConversionUtils::Stream<char, char8_t> stream;
+        std::u8string                          out;
+        EXPECT_EQ(ConversionUtils::status::ok, stream.feed("a\xC3", out).status);
+        EXPECT_EQ(ConversionUtils::status::ok, stream.feed("\xA9", out).status);
+        EXPECT_TRUE(std::u8string(u8"a\u00E9") == out);
+    }
+
+
+    // =========================================================================
+    // Parallel conversion of large buffers
+    // =========================================================================
+
+    TEST(ConversionUtils, parallel_matches_serial)
+    {
+        // ~3 MB so the input is split into several chunks; sequences straddle the cut points
+        std::string src;
+        while (src.size() < 3 * 1024 * 1024) src += kMixed8;
+
+        auto wide = ConversionUtils::convert_to_parallel<char, wchar_t>(src, 4);
+        EXPECT_TRUE(wide == (ConversionUtils::convert_to<char, wchar_t>(src)));
+
+        auto u16 = ConversionUtils::convert_to_parallel<char, char16_t>(src, 3);
+        EXPECT_TRUE(u16 == (ConversionUtils::convert_to<char, char16_t>(src)));
+
+        auto narrow = ConversionUtils::convert_to_parallel<char16_t, char>(u16, 4);
+        EXPECT_EQ(src, narrow);
+    }
+
+    TEST(ConversionUtils, parallel_small_input)
+    {
+        EXPECT_EQ(std::wstring(L"hello"), (ConversionUtils::convert_to_parallel<char, wchar_t>(std::string_view {"hello"})));
+        EXPECT_EQ(std::u16string(), (ConversionUtils::convert_to_parallel<char, char16_t>(std::string_view {})));
+    }
+
+    TEST(ConversionUtils, parallel_malformed_input)
+    {
+        std::string src(2 * 1024 * 1024, 'x');
+        src[1024 * 1024 + 7] = '\xC0';
+
+        EXPECT_THROW((ConversionUtils::convert_to_parallel<char, wchar_t>(src, 4)), std::range_error);
+
+        auto replaced = ConversionUtils::convert_to_parallel<char, wchar_t, error_policy::replace>(src, 4);
+        EXPECT_EQ((ConversionUtils::convert_to<char, wchar_t, error_policy::replace>(src)), replaced);
+
+        auto reported = ConversionUtils::convert_to_parallel<char, wchar_t, error_policy::report>(src, 4);
+        ASSERT_FALSE(reported);
+        EXPECT_EQ(1024u * 1024 + 7, reported.error().consumed);
+    }
+
+
+    // =========================================================================
+    // Compile-time conversion of literals
+    // =========================================================================
+
+    TEST(ConversionUtils, ct_convert_matches_convert_to)
+    {
+        constexpr std::wstring_view wide = ConversionUtils::ct_convert<"A\xC3\xA9\xE4\xB8\x96\xF0\x9F\x98\x80 z">();
+        static_assert(wide.size() == (sizeof(wchar_t) == 2 ? 7 : 6));
+        static_assert(wide.data()[wide.size()] == L'\0');
+        EXPECT_EQ(kMixedW, wide);
+
+        constexpr auto narrow = ConversionUtils::ct_convert<u"A\u00E9\u4E16\U0001F600 z", char>();
+        EXPECT_EQ(kMixed8, narrow);
+
+        constexpr auto u32 = ConversionUtils::ct_convert<u8"A\u00E9\u4E16\U0001F600 z", char32_t>();
+        EXPECT_EQ(kMixed32, u32);
+    }
+
+    TEST(ConversionUtils, ct_array_is_constexpr_table)
+    {
+        constexpr auto table = ConversionUtils::ct_array<U"\U0001F600", char16_t>();
+        static_assert(table.size() == 3);
+        static_assert(table[0] == 0xD83D && table[1] == 0xDE00 && table[2] == 0);
+
+        EXPECT_TRUE(std::u16string_view(table.data()) == (ConversionUtils::convert_to<char32_t, char16_t>(std::u32string {U"\U0001F600"})));
+    }
+
+
+    // =========================================================================
+    // Batch conversion into one buffer
+    // =========================================================================
+
+    TEST(ConversionUtils, batch_matches_convert_to)
+    {
+        std::vector<std::string> inputs {"Content-Type", "", kMixed8, "q=\xC3\xA9t\xC3\xA9", "x"};
+
+        auto batch = ConversionUtils::convert_batch<char, wchar_t>(inputs);
+        ASSERT_EQ(inputs.size(), batch.size());
+        for (size_t i = 0; i < inputs.size(); i++) {
+            EXPECT_EQ((ConversionUtils::convert_to<char, wchar_t>(inputs[i])), batch[i]) << i;
+        }
+
+        // Offsets describe the packed buffer
+        auto offsets = batch.offsets();
+        ASSERT_EQ(inputs.size() + 1, offsets.size());
+        EXPECT_EQ(0u, offsets.front());
+        EXPECT_EQ(batch[2].data(), batch.data() + offsets[2]);
+
+        auto views = batch.views();
+        EXPECT_EQ(batch[3], views[3]);
+    }
+
+    TEST(ConversionUtils, batch_of_views_and_pointers)
+    {
+        const char* names[] {"alpha", "\xE4\xB8\x96", "gamma"};
+        auto        batch = ConversionUtils::convert_batch<char, char16_t>(names);
+        EXPECT_EQ(3u, batch.size());
+        EXPECT_TRUE(batch[1] == std::u16string_view {u"\u4E16"});
+
+        std::vector<std::u16string_view> keys {u"a", u"\U0001F600"};
+        auto                             narrow = ConversionUtils::convert_batch<char16_t, char>(keys);
+        EXPECT_EQ(std::string_view {"\xF0\x9F\x98\x80"}, narrow[1]);
+
+        EXPECT_TRUE((ConversionUtils::convert_batch<char, wchar_t>(std::vector<std::string> {})).empty());
+    }
+
+    TEST(ConversionUtils, batch_policies)
+    {
+        std::vector<std::u16string> inputs {u"a", std::u16string {u'\xDC00', u'\xDC01'}, u"b"};
+
+        EXPECT_THROW((ConversionUtils::convert_batch<char16_t, char>(inputs)), std::range_error);
+
+        auto replaced = ConversionUtils::convert_batch<char16_t, char, error_policy::replace>(inputs);
+        EXPECT_EQ(std::string_view {"a"}, replaced[0]);
+        EXPECT_EQ(std::string_view {"\xEF\xBF\xBD\xEF\xBF\xBD"}, replaced[1]);
+        EXPECT_EQ(std::string_view {"b"}, replaced[2]);
+
+        auto skipped = ConversionUtils::convert_batch<char16_t, char, error_policy::skip>(inputs);
+        EXPECT_TRUE(skipped[1].empty());
+        EXPECT_EQ(std::string_view {"b"}, skipped[2]);
+    }
+
+
+    // =========================================================================
+    // Allocator-aware and std::pmr conversions
+    // =========================================================================
+
+    /// @brief Counts the allocations made through it
+    template <typename T>
+    struct counting_allocator
+    {
+        using value_type = T;
+
+        size_t* count;
+
+        explicit counting_allocator(size_t* c) noexcept
+            : count(c)
+        {
+        }
+
+        template <typename U>
+        counting_allocator(const counting_allocator<U>& other) noexcept
+            : count(other.count)
+        {
+        }
+
+        T* allocate(size_t n)
+        {
+            ++*count;
+            return std::allocator<T> {}.allocate(n);
+        }
+
+        void deallocate(T* p, size_t n) noexcept { std::allocator<T> {}.deallocate(p, n); }
+
+        bool operator==(const counting_allocator& other) const noexcept { return count == other.count; }
+    };
+
+    TEST(ConversionUtils, convert_to_custom_allocator)
+    {
+        size_t allocations {0};
+        auto   wide = ConversionUtils::convert_to<char, wchar_t>(std::string_view {kMixed8 + kMixed8},
+                                                               counting_allocator<wchar_t> {&allocations});
+        EXPECT_EQ(kMixedW + kMixedW, std::wstring_view(wide.data(), wide.size()));
+        EXPECT_GE(allocations, 1u);
+        EXPECT_EQ(&allocations, wide.get_allocator().count);
+    }
+
+    TEST(ConversionUtils, convert_to_pmr_arena)
+    {
+        // Every byte must come from the arena; the upstream resource refuses to allocate
+        std::byte                           buffer[4096];
+        std::pmr::monotonic_buffer_resource arena {buffer, sizeof(buffer), std::pmr::null_memory_resource()};
+
+        std::pmr::wstring wide = ConversionUtils::convert_to<char, wchar_t>(std::string_view {kMixed8 + kMixed8}, &arena);
+        EXPECT_EQ(kMixedW + kMixedW, std::wstring_view(wide));
+        EXPECT_EQ(&arena, wide.get_allocator().resource());
+
+        std::pmr::string narrow = ConversionUtils::convert_to<char16_t, char>(std::u16string_view {kMixed16}, &arena);
+        EXPECT_EQ(kMixed8, std::string_view(narrow));
+
+        // Appending keeps the destination's allocator
+        std::pmr::u32string u32 {&arena};
+        EXPECT_EQ(ConversionUtils::status::ok, (ConversionUtils::convert_into<char, char32_t>(kMixed8, u32).status));
+        EXPECT_TRUE(kMixed32 == std::u32string_view(u32));
+
+        auto bad = ConversionUtils::convert_to<char, wchar_t, error_policy::report>(std::string_view {"\xFF"}, &arena);
+        EXPECT_FALSE(bad.has_value());
+    }
+
+
+    // =========================================================================
+    // Single-byte codepages
+    // =========================================================================
+
+    TEST(ConversionUtils, codepage_cp1252)
+    {
+        const std::string_view bytes {"Caf\xE9 \x80" "5 \x93quoted\x94 \x85"};
+
+        EXPECT_EQ(L"Caf\x00E9 \x20AC" L"5 \x201Cquoted\x201D \x2026", (ConversionUtils::convert_to<codepage::cp1252, wchar_t>(bytes)));
+        EXPECT_EQ("Caf\xC3\xA9 \xE2\x82\xAC" "5 \xE2\x80\x9Cquoted\xE2\x80\x9D \xE2\x80\xA6", (ConversionUtils::convert_to<codepage::cp1252, char>(bytes)));
+        EXPECT_EQ(bytes, (ConversionUtils::convert_to<wchar_t, codepage::cp1252>(ConversionUtils::convert_to<codepage::cp1252, wchar_t>(bytes))));
+
+        // Bytes Windows leaves undefined decode to the C1 control of the same value
+        EXPECT_EQ(u"\x0081", (ConversionUtils::convert_to<codepage::cp1252, char16_t>(std::string_view {"\x81"})));
+
+        // All-ASCII input is a plain copy
+        EXPECT_EQ("Content-Type", (ConversionUtils::convert_to<codepage::cp1252, char>(std::string_view {"Content-Type"})));
+        EXPECT_EQ(U"Content-Type", (ConversionUtils::convert_to<codepage::cp1252, char32_t>(std::string_view {"Content-Type"})));
+        EXPECT_EQ("", (ConversionUtils::convert_to<codepage::cp1252, char>(std::string_view {})));
+    }
+
+    template <typename CP>
+    void codepage_roundtrip()
+    {
+        for (unsigned b = 0; b < 256; b++) {
+            const char byte = static_cast<char>(b);
+            if (b >= 0x80 && CP::table.to_unicode[b - 0x80] == 0xFFFF) continue;
+
+            const auto utf8  = ConversionUtils::convert_to<CP, char>(std::string_view {&byte, 1});
+            const auto wide  = ConversionUtils::convert_to<CP, wchar_t>(std::string_view {&byte, 1});
+            const auto utf16 = ConversionUtils::convert_to<CP, char16_t>(std::string_view {&byte, 1});
+            EXPECT_EQ(wide, (ConversionUtils::convert_to<char, wchar_t>(utf8))) << CP::name << " " << b;
+            EXPECT_EQ(std::string(1, byte), (ConversionUtils::convert_to<char, CP>(utf8))) << CP::name << " " << b;
+            EXPECT_EQ(std::string(1, byte), (ConversionUtils::convert_to<wchar_t, CP>(wide))) << CP::name << " " << b;
+            EXPECT_EQ(std::string(1, byte), (ConversionUtils::convert_to<char16_t, CP>(utf16))) << CP::name << " " << b;
+        }
+    }
+
+    TEST(ConversionUtils, codepage_roundtrip_every_byte)
+    {
+        codepage_roundtrip<codepage::latin1>();
+        codepage_roundtrip<codepage::cp1250>();
+        codepage_roundtrip<codepage::cp1251>();
+        codepage_roundtrip<codepage::cp1252>();
+        codepage_roundtrip<codepage::iso8859_2>();
+        codepage_roundtrip<codepage::iso8859_5>();
+        codepage_roundtrip<codepage::iso8859_7>();
+        codepage_roundtrip<codepage::iso8859_15>();
+
+        EXPECT_EQ(U"\x00A4\x20AC", (ConversionUtils::convert_to<codepage::iso8859_1, char32_t>(std::string_view {"\xA4"}) +
+                                     ConversionUtils::convert_to<codepage::iso8859_15, char32_t>(std::string_view {"\xA4"})));
+        EXPECT_EQ(L"\x0416", (ConversionUtils::convert_to<codepage::cp1251, wchar_t>(std::string_view {"\xC6"})));
+    }
+
+    TEST(ConversionUtils, codepage_every_offset)
+    {
+        // One non-ASCII byte moved through several vector blocks
+        for (size_t pos = 0; pos < 100; pos++) {
+            std::string bytes(100, 'x');
+            bytes[pos] = '\xE9';
+            std::wstring wide(100, L'x');
+            wide[pos] = L'\x00E9';
+
+            EXPECT_EQ(wide, (ConversionUtils::convert_to<codepage::latin1, wchar_t>(bytes))) << pos;
+            EXPECT_EQ(bytes, (ConversionUtils::convert_to<wchar_t, codepage::latin1>(wide))) << pos;
+            EXPECT_EQ(bytes, (ConversionUtils::convert_to<char, codepage::latin1>(ConversionUtils::convert_to<wchar_t, char>(wide)))) << pos;
+        }
+    }
+
+    TEST(ConversionUtils, codepage_policies)
+    {
+        // 0xA5 is undefined in ISO-8859-3; the euro sign is not in Latin-1
+        const std::string_view undefined {"ab\xA5" "c"};
+        EXPECT_THROW((ConversionUtils::convert_to<codepage::iso8859_3, char>(undefined)), std::range_error);
+        EXPECT_EQ("ab\xEF\xBF\xBD" "c", (ConversionUtils::convert_to<codepage::iso8859_3, char, error_policy::replace>(undefined)));
+        EXPECT_EQ(L"abc", (ConversionUtils::convert_to<codepage::iso8859_3, wchar_t, error_policy::skip>(undefined)));
+        auto decoded = ConversionUtils::convert_to<codepage::iso8859_3, wchar_t, error_policy::report>(undefined);
+        ASSERT_FALSE(decoded.has_value());
+        EXPECT_EQ(2u, decoded.error().consumed);
+
+        const std::string_view euro {"1\xE2\x82\xAC = \xFF"};
+        EXPECT_THROW((ConversionUtils::convert_to<char, codepage::latin1>(euro)), std::range_error);
+        EXPECT_EQ("1? = ?", (ConversionUtils::convert_to<char, codepage::latin1, error_policy::replace>(euro)));
+        EXPECT_EQ("1 = ", (ConversionUtils::convert_to<char, codepage::latin1, error_policy::skip>(euro)));
+        EXPECT_EQ("1\x80 = ", (ConversionUtils::convert_to<char, codepage::cp1252, error_policy::skip>(euro)));
+        auto encoded = ConversionUtils::convert_to<char, codepage::latin1, error_policy::report>(euro);
+        ASSERT_FALSE(encoded.has_value());
+        EXPECT_EQ(1u, encoded.error().consumed);
+        EXPECT_EQ(ConversionUtils::status::invalid_sequence, encoded.error().status);
+    }
+
+
     // =========================================================================
     // Default template parameters (char -> wchar_t)
     // =========================================================================
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""
+StringHelpers : generates include/siddiqsoft/case-fold-table.hpp
+
+The table holds the Unicode simple case folding (CaseFolding.txt status C and S) for every code
+point above U+007F, taken from the Unicode database bundled with Python (`unicodedata`). Python
+exposes the full folding (`str.casefold`); where that expands to several code points the simple
+folding is the single-code-point lowercase mapping, if there is one.
+
+Mappings are stored as runs: code points first, first + stride, ... last all fold by adding the same
+delta. Upper/lower case blocks (stride 1) and alternating pairs (stride 2) make the table small.
+
+Usage: python3 tools/gen-case-fold-table.py > include/siddiqsoft/case-fold-table.hpp
+"""
+
+import sys
+import unicodedata
+
+
+LICENSE = """/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    Generated by tools/gen-case-fold-table.py from Unicode %s -- do not edit.
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */"""
+
+
+def simple_fold(cp):
+    c = chr(cp)
+    folded = c.casefold()
+    if len(folded) == 1:
+        return ord(folded)
+    lower = c.lower()
+    if len(lower) == 1:
+        return ord(lower)
+    return cp
+
+
+def runs():
+    mapped = [(cp, simple_fold(cp) - cp) for cp in range(0x80, 0x110000) if simple_fold(cp) != cp]
+    out = []
+    for cp, delta in mapped:
+        if out:
+            first, last, stride, d = out[-1]
+            if d == delta and ((stride == 0 and cp - last in (1, 2)) or (stride and cp - last == stride)):
+                out[-1] = (first, cp, cp - last, d)
+                continue
+        out.append((cp, cp, 0, delta))
+    return [(first, last, stride or 1, delta) for first, last, stride, delta in out]
+
+
+def main():
+    table = runs()
+    w = sys.stdout.write
+    w(LICENSE % unicodedata.unidata_version + "\n\n")
+    w("#pragma once\n\n#ifndef CASE_FOLD_TABLE_HPP\n#define CASE_FOLD_TABLE_HPP\n\n\n")
+    w("#include <cstdint>\n\n\n")
+    w("namespace siddiqsoft::casefold\n{\n")
+    w("    /// @brief Code points first, first + stride, ..., last fold to themselves plus delta\n")
+    w("    struct fold_run\n    {\n")
+    w("        char32_t     first;\n        char32_t     last;\n        std::uint8_t stride;\n        std::int32_t delta;\n    };\n\n")
+    w("    /// @brief Unicode %s simple case folding above U+007F (%d runs), sorted by first\n" % (unicodedata.unidata_version, len(table)))
+    w("    inline constexpr fold_run fold_runs[] = {\n")
+    for first, last, stride, delta in table:
+        w("            {0x%05X, 0x%05X, %d, %d},\n" % (first, last, stride, delta))
+    w("    };\n} // namespace siddiqsoft::casefold\n\n#endif\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""
+StringHelpers : generates include/siddiqsoft/codepage-tables.hpp
+
+Byte to code point tables (and the sorted reverse mappings) for the single-byte codepages, taken from
+Python's codecs. Bytes 0x00-0x7F are ASCII in all of them and are not stored. Bytes the Windows
+codepages leave undefined map to the C1 control with the same value, as Windows and the WHATWG
+Encoding Standard do; undefined bytes in the ISO 8859 parts are errors (0xFFFF in the table).
+
+Usage: python3 tools/gen-codepage-tables.py > include/siddiqsoft/codepage-tables.hpp
+"""
+
+import sys
+import unicodedata
+
+
+LICENSE = """/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    Generated by tools/gen-codepage-tables.py (Python unicodedata %s) -- do not edit.
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */"""
+
+# (tag, Python codec, label)
+CODEPAGES = [("latin1", "latin_1", "ISO-8859-1"),
+             ("cp1250", "cp1250", "windows-1250"),
+             ("cp1251", "cp1251", "windows-1251"),
+             ("cp1252", "cp1252", "windows-1252")] + \
+            [("iso8859_%d" % n, "iso8859_%d" % n, "ISO-8859-%d" % n) for n in range(2, 17) if n != 12]
+
+UNDEFINED = 0xFFFF
+
+
+def decode_table(codec):
+    table = []
+    for b in range(0x80, 0x100):
+        try:
+            table.append(ord(bytes([b]).decode(codec)))
+        except UnicodeDecodeError:
+            table.append(b if codec.startswith("cp") else UNDEFINED)
+    return table
+
+
+def main():
+    w = sys.stdout.write
+    w(LICENSE % unicodedata.unidata_version + "\n\n")
+    w("#pragma once\n\n#ifndef CODEPAGE_TABLES_HPP\n#define CODEPAGE_TABLES_HPP\n\n\n")
+    w("#include <cstdint>\n#include <string_view>\n\n\n")
+    w("namespace siddiqsoft::codepage\n{\n")
+    w("    /// @brief Byte `b` (0x80-0xFF) to code point, `to_unicode[b - 0x80]` (0xFFFF when undefined); `from_unicode` holds\n")
+    w("    /// the `count` defined mappings sorted by code point\n")
+    w("    struct single_byte_table\n    {\n")
+    w("        struct entry\n        {\n            char16_t     cp;\n            std::uint8_t byte;\n        };\n\n")
+    w("        char16_t     to_unicode[128];\n        std::uint8_t count;\n        entry        from_unicode[128];\n    };\n\n")
+
+    for tag, codec, label in CODEPAGES:
+        table   = decode_table(codec)
+        reverse = sorted((cp, 0x80 + i) for i, cp in enumerate(table) if cp != UNDEFINED)
+        w("    inline constexpr single_byte_table %s_table {\n" % tag)
+        w("            {\n")
+        for i in range(0, 128, 16):
+            w("                    " + ", ".join("0x%04X" % x for x in table[i:i + 16]) + ",\n")
+        w("            },\n")
+        w("            %d,\n" % len(reverse))
+        w("            {\n")
+        for i in range(0, len(reverse), 8):
+            w("                    " + ", ".join("{0x%04X, 0x%02X}" % x for x in reverse[i:i + 8]) + ",\n")
+        w("            }};\n\n")
+
+    w("    // Tags naming a codepage in ConversionUtils::convert_to, e.g. convert_to<codepage::cp1252, char>\n\n")
+    for tag, codec, label in CODEPAGES:
+        w("    struct %s\n    {\n" % tag)
+        w("        static constexpr std::string_view         name {\"%s\"};\n" % label)
+        w("        static constexpr const single_byte_table& table = %s_table;\n    };\n\n" % tag)
+    w("    using iso8859_1 = latin1;\n")
+    w("} // namespace siddiqsoft::codepage\n\n#endif\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""
+StringHelpers : generates include/siddiqsoft/normalization-tables.hpp
+
+Tables for NFC/NFD normalization taken from the Unicode database bundled with Python (`unicodedata`):
+
+- Per code point properties (canonical combining class and the NFD_QC/NFC_QC quick-check values) in a
+  two-stage table: `stage1[cp >> stage_shift]` picks a block and the entry for `cp` in that block of
+  `stage2` is the index of its property record. Identical blocks are stored once.
+- The full canonical decomposition of every code point that has one, sorted by code point. Hangul
+  syllables are left out; they are decomposed and composed algorithmically.
+- The primary composites (pairs that NFC recombines), sorted by (first, second).
+
+Usage: python3 tools/gen-normalization-tables.py > include/siddiqsoft/normalization-tables.hpp
+"""
+
+import sys
+import unicodedata
+
+
+LICENSE = """/*
+    StringHelpers : Simple wide, narrow, utf8 conversion functions
+
+    Generated by tools/gen-normalization-tables.py from Unicode %s -- do not edit.
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+ */"""
+
+SHIFT = 7
+
+# Flags in a property record
+NFD_NO    = 1
+NFC_NO    = 2
+NFC_MAYBE = 4
+
+
+def is_hangul_syllable(cp):
+    return 0xAC00 <= cp <= 0xD7A3
+
+
+def code_points():
+    return (cp for cp in range(0x110000) if not 0xD800 <= cp <= 0xDFFF)
+
+
+def compositions():
+    pairs = []
+    for cp in code_points():
+        d = unicodedata.decomposition(chr(cp))
+        if not d or d.startswith("<"):
+            continue
+        parts = [int(x, 16) for x in d.split()]
+        if len(parts) == 2 and unicodedata.normalize("NFC", chr(parts[0]) + chr(parts[1])) == chr(cp):
+            pairs.append((parts[0], parts[1], cp))
+    return sorted(pairs)
+
+
+def rows(items, per_row, fmt, sep=" "):
+    return "".join("            " + sep.join(fmt % x for x in items[i:i + per_row]) + ",\n" for i in range(0, len(items), per_row))
+
+
+def main():
+    pairs  = compositions()
+    second = {b for _, b, _ in pairs} | set(range(0x1161, 0x1176)) | set(range(0x11A8, 0x11C3))
+
+    records = [(0, 0)]
+    index   = {(0, 0): 0}
+    props   = [0] * 0x110000
+    decomps = []
+    for cp in code_points():
+        c     = chr(cp)
+        nfd   = unicodedata.normalize("NFD", c)
+        flags = (NFD_NO if nfd != c else 0) | (NFC_NO if unicodedata.normalize("NFC", c) != c else 0)
+        flags |= NFC_MAYBE if cp in second else 0
+        rec = (unicodedata.combining(c), flags)
+        if rec not in index:
+            index[rec] = len(records)
+            records.append(rec)
+        props[cp] = index[rec]
+        if nfd != c and not is_hangul_syllable(cp):
+            decomps.append((cp, [ord(x) for x in nfd]))
+
+    block_size = 1 << SHIFT
+    blocks, stage1 = {}, []
+    for b in range(0, 0x110000, block_size):
+        stage1.append(blocks.setdefault(tuple(props[b:b + block_size]), len(blocks)))
+    stage2 = [x for block in sorted(blocks, key=blocks.get) for x in block]
+
+    assert len(records) < 256 and len(blocks) < 256
+
+    entries, pool = [], []
+    for cp, parts in decomps:
+        entries.append((cp, len(pool), len(parts)))
+        pool.extend(parts)
+
+    w = sys.stdout.write
+    w(LICENSE % unicodedata.unidata_version + "\n\n")
+    w("#pragma once\n\n#ifndef NORMALIZATION_TABLES_HPP\n#define NORMALIZATION_TABLES_HPP\n\n\n")
+    w("#include <cstdint>\n\n\n")
+    w("namespace siddiqsoft::normalization\n{\n")
+    w("    inline constexpr std::uint8_t nfd_no    = %d;\n" % NFD_NO)
+    w("    inline constexpr std::uint8_t nfc_no    = %d;\n" % NFC_NO)
+    w("    inline constexpr std::uint8_t nfc_maybe = %d;\n\n" % NFC_MAYBE)
+
+    w("    /// @brief Canonical combining class and quick-check flags of a code point\n")
+    w("    struct property\n    {\n        std::uint8_t ccc;\n        std::uint8_t flags;\n    };\n\n")
+    w("    inline constexpr property properties[] = {\n")
+    w(rows(records, 8, "{%d, %d}", ", "))
+    w("    };\n\n")
+
+    w("    inline constexpr unsigned stage_shift = %d;\n\n" % SHIFT)
+    w("    inline constexpr std::uint8_t stage1[] = {\n" + rows(stage1, 32, "%d", ",") + "    };\n\n")
+    w("    inline constexpr std::uint8_t stage2[] = {\n" + rows(stage2, 32, "%d", ",") + "    };\n\n")
+
+    w("    /// @brief `length` code points at `decomposition_pool[offset]` are the full canonical decomposition of `cp`\n")
+    w("    struct decomposition\n    {\n        char32_t      cp;\n        std::uint16_t offset;\n        std::uint16_t length;\n    };\n\n")
+    w("    inline constexpr decomposition decompositions[] = {\n" + rows(entries, 4, "{0x%05X, %d, %d}", ", ") + "    };\n\n")
+    w("    inline constexpr char32_t decomposition_pool[] = {\n" + rows(pool, 12, "0x%05X", ", ") + "    };\n\n")
+
+    w("    /// @brief `first` followed by `second` composes to `composite`\n")
+    w("    struct composition\n    {\n        char32_t first;\n        char32_t second;\n        char32_t composite;\n    };\n\n")
+    w("    inline constexpr composition compositions[] = {\n" + rows(pairs, 4, "{0x%05X, 0x%05X, 0x%05X}", ", ") + "    };\n")
+    w("} // namespace siddiqsoft::normalization\n\n#endif\n")
+
+
+if __name__ == "__main__":
+    main()